@@ -3,18 +3,24 @@
 
 #include <iostream>
 #include <algorithm>
+#include <atomic>
 #include "tree.h"
 
 using namespace std;
 
-extern const int MAX;
-extern const int MIN;
-extern int nodeCount;
-
-int alfabeta(Node* node, bool isMaxPlayer, int depth, int alpha, int beta) {
-    nodeCount++;  // visited node count
+// nodeCount is increased by visited node count
+// isLeafValueSet if leaf values were set by Tree::evaluateLeaves
+// search returns 0 without a result as soon as stopFlag is set
+inline int alfabeta(Node* node, bool isMaxPlayer, int depth, int alpha, int beta, int& nodeCount,
+                    bool isLeafValueSet = false, const atomic<bool>* stopFlag = nullptr) {
+    if (stopFlag && stopFlag->load(memory_order_relaxed))
+        return 0;
+    nodeCount++;
 
     // if leaf node or set depth has been reached, return heuristic function value
+    if (isLeafValueSet && node->isLeaf())
+        return node->getValue();
+
     if (node->getState().hasFinished() || depth == 0) {
         int value = node->getState().heuristicValue();
         // set nodes heuristic value, so that best child node can be found
@@ -32,7 +38,7 @@ int alfabeta(Node* node, bool isMaxPlayer, int depth, int alpha, int beta) {
         for (Node* child : children) {
             // act as minimizing player (isMaxPlayer = false)
             // reduce depth by 1
-            int value = alfabeta(child, false, depth - 1, alpha, beta);
+            int value = alfabeta(child, false, depth - 1, alpha, beta, nodeCount, isLeafValueSet, stopFlag);
             bestValue = max(bestValue, value);
 
             // set new alpha if higher
@@ -56,7 +62,7 @@ int alfabeta(Node* node, bool isMaxPlayer, int depth, int alpha, int beta) {
         for (Node* child : children) {
             // act as minimizing player (isMaxPlayer = false)
             // reduce depth by 1
-            int value = alfabeta(child, true, depth - 1, alpha, beta);
+            int value = alfabeta(child, true, depth - 1, alpha, beta, nodeCount, isLeafValueSet, stopFlag);
             bestValue = min(bestValue, value);
 
             // set new beta if lower
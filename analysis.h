@@ -0,0 +1,111 @@
+#ifndef ANALYSIS_H
+#define ANALYSIS_H
+
+#include <unordered_map>
+#include "state.h"
+#include "external.h"
+
+using namespace std;
+
+// value of one legal move
+struct MoveValue {
+    int number;   // picked number
+    bool divide;  // number is divided, otherwise removed
+    int value;    // minimax value after the move
+};
+
+/*
+multi-PV analysis, searches every root move to the same depth as minimax over the tree
+all root moves share one cache of (state, player, depth) values, which is kept between
+calls, so after a move most of the new position's values are already known
+moves are applied to packed states directly, State is only built for heuristic values
+*/
+class MultiPvSearch {
+private:
+    struct Key {
+        PackedState state;
+        int depth;
+        bool isMaxPlayer;
+
+        bool operator==(const Key& key) const {
+            return state == key.state && depth == key.depth && isMaxPlayer == key.isMaxPlayer;
+        }
+    };
+
+    struct KeyHash {
+        size_t operator()(const Key& key) const {
+            return hash<PackedState>()(key.state) ^ (size_t(key.depth) << 1 | key.isMaxPlayer) * 0x9e3779b97f4a7c15ULL;
+        }
+    };
+
+    static constexpr size_t MAX_CACHE_SIZE = 1 << 22;  // entries kept before a cache is cleared
+
+    unordered_map<Key, int, KeyHash> cache;        // searched values
+    unordered_map<PackedState, int> leafValues;    // heuristic values
+
+    int heuristicValue(PackedState state) {
+        auto result = leafValues.find(state);
+        if (result != leafValues.end())
+            return result->second;
+
+        int value = unpackState(state).heuristicValue();
+        if (leafValues.size() >= MAX_CACHE_SIZE)
+            leafValues.clear();
+        leafValues.emplace(state, value);
+        return value;
+    }
+
+    // minimax value over packed states, same moves as State::doAction
+    // leaf node or depth 0 gives heuristic value
+    int search(PackedState state, bool isMaxPlayer, int depth) {
+        if (isPackedFinished(state) || depth == 0)
+            return heuristicValue(state);
+
+        Key key = {state, depth, isMaxPlayer};
+        auto result = cache.find(key);
+        if (result != cache.end())
+            return result->second;
+
+        PackedState children[6];
+        int childCount = packedChildStates(state, children);
+
+        int bestValue = isMaxPlayer ? MIN : MAX;
+        for (int i = 0; i < childCount; i++) {
+            int value = search(children[i], !isMaxPlayer, depth - 1);
+            bestValue = isMaxPlayer ? max(bestValue, value) : min(bestValue, value);
+        }
+
+        // limit is checked on every insert, one deep analysis can't grow the cache past it
+        if (cache.size() >= MAX_CACHE_SIZE)
+            cache.clear();
+        cache.emplace(key, bestValue);
+        return bestValue;
+    }
+
+public:
+    // returns values of all legal moves, in the same order as tree child nodes
+    vector<MoveValue> analyze(State state, bool isMaxPlayer, int depth) {
+        vector<MoveValue> moves;
+
+        for (int number : state.getUniqueNumbers()) {
+            for (bool divide : {false, true}) {
+                if (divide && number != 2 && number != 4) continue;
+
+                State childState = state;
+                childState.doAction(number, divide);
+                moves.push_back({number, divide, search(packState(childState), !isMaxPlayer, depth - 1)});
+            }
+        }
+
+        return moves;
+    }
+
+    void clear() {
+        cache.clear();
+        leafValues.clear();
+    }
+
+    size_t getCacheSize() const { return cache.size(); }
+};
+
+#endif // ANALYSIS_H
@@ -0,0 +1,277 @@
+#include <algorithm>
+#include <condition_variable>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <deque>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include "engine.h"
+
+using namespace std;
+
+/*
+batch analysis of positions, streamed from a file or stdin to stdout
+
+usage: batch [--input file] [--algorithm A] [--depth D] [--threads T] [--memory MB]
+algorithm numbers are the same as in the game, default is the exact solver (3),
+memory is the tree memory limit of one search
+
+every input line is one position, # starts a comment, empty lines are skipped
+  4 2 1 3 3 2        sequence of numbers, spaces are optional (421332)
+  (5, 2, 0, 3)       counts of numbers 1, 2, 3 and 4
+followed by optional p=<points> b=<bank> and max or min for the player to move,
+defaults are p=0 b=0 max, points and bank can't be negative and the weight of the
+numbers (count of 1 and 3, 2 per 2, 4 per 4) can't be above PACKED_COUNT_MAX
+every position gives one output line, in input order
+  <line> <value> remove|divide <number>    best move, "none" for end states
+  <line> error <message>
+
+lines are read in chunks, which are searched in parallel, at most a few chunks per
+thread are kept in memory, so memory use doesn't depend on input size
+*/
+
+const int CHUNK_LINES = 1024;     // lines in one chunk
+const int CHUNKS_PER_THREAD = 4;  // chunks read ahead per search thread
+
+struct Position {
+    State state;
+    bool isMaxPlayer;
+};
+
+struct Chunk {
+    long long firstLine;  // number of first line, from 1
+    vector<string> lines;
+    string output;        // results of all lines
+    bool isDone = false;
+};
+
+// parses points or bank value, returns false if it isn't a non-negative number
+bool parseValue(const string& text, int& value) {
+    if (text.empty() || text.size() > 9 || text.find_first_not_of("0123456789") != string::npos)
+        return false;
+    value = atoi(text.c_str());
+    return true;
+}
+
+// parses one line, returns false with error message if line is invalid
+bool parsePosition(const string& line, Position& position, string& error) {
+    map<int, int> numbers = {{1, 0}, {2, 0}, {3, 0}, {4, 0}};
+    int points = 0, bank = 0;
+    position.isMaxPlayer = true;
+
+    istringstream stream(line);
+    string token;
+    bool hasNumbers = false;
+
+    // count tuple
+    size_t open = line.find('(');
+    if (open != string::npos) {
+        size_t close = line.find(')', open);
+        if (close == string::npos) {
+            error = "missing )";
+            return false;
+        }
+
+        string tuple = line.substr(open + 1, close - open - 1);
+        replace(tuple.begin(), tuple.end(), ',', ' ');
+        istringstream tupleStream(tuple);
+        for (int number = 1; number <= 4; number++) {
+            if (!(tupleStream >> numbers[number]) || numbers[number] < 0) {
+                error = "count tuple needs 4 counts";
+                return false;
+            }
+        }
+
+        hasNumbers = true;
+        stream.str(line.substr(0, open) + " " + line.substr(close + 1));
+    }
+
+    while (stream >> token) {
+        if (token == "max" || token == "min") {
+            position.isMaxPlayer = token == "max";
+        } else if (token.size() > 2 && token.compare(0, 2, "p=") == 0) {
+            if (!parseValue(token.substr(2), points)) {
+                error = "invalid points " + token.substr(2);
+                return false;
+            }
+        } else if (token.size() > 2 && token.compare(0, 2, "b=") == 0) {
+            if (!parseValue(token.substr(2), bank)) {
+                error = "invalid bank " + token.substr(2);
+                return false;
+            }
+        } else if (open == string::npos && token.find_first_not_of("1234") == string::npos) {
+            for (char digit : token) {
+                numbers[digit - '0']++;
+            }
+            hasNumbers = true;
+        } else {
+            error = "unknown token " + token;
+            return false;
+        }
+    }
+
+    if (!hasNumbers) {
+        error = "no numbers";
+        return false;
+    }
+
+    position.state = State(numbers, points, bank);
+
+    // packed states of the engines hold counts only up to PACKED_COUNT_MAX
+    if (!isPackable(position.state)) {
+        error = "too many numbers";
+        return false;
+    }
+    return true;
+}
+
+// searches all positions of chunk
+void analyzeChunk(Chunk& chunk, const SearchSettings& settings) {
+    ostringstream out;
+
+    for (size_t i = 0; i < chunk.lines.size(); i++) {
+        string line = chunk.lines[i].substr(0, chunk.lines[i].find('#'));
+        if (line.find_first_not_of(" \t\r") == string::npos) continue;
+
+        long long lineNumber = chunk.firstLine + i;
+        Position position;
+        string error;
+        if (!parsePosition(line, position, error)) {
+            out << lineNumber << " error " << error << "\n";
+            continue;
+        }
+
+        MoveResult result = searchMove(position.state, position.isMaxPlayer, settings);
+        out << lineNumber << " " << result.value;
+
+        // move that leads to the best state
+        string move = " none";
+        for (int number : position.state.getUniqueNumbers()) {
+            for (bool divide : {false, true}) {
+                if (divide && number != 2 && number != 4) continue;
+
+                State childState = position.state;
+                childState.doAction(number, divide);
+                if (childState == result.bestState)
+                    move = (divide ? " divide " : " remove ") + to_string(number);
+            }
+        }
+        out << move << "\n";
+    }
+
+    chunk.output = out.str();
+}
+
+int main(int argc, char *argv[]) {
+    string inputPath;
+    int threadCount = max(1u, thread::hardware_concurrency());
+    SearchSettings settings;
+    settings.algorithmType = 3;
+    settings.memoryBudget = size_t(64) * 1024 * 1024;
+
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (strcmp(argv[i], "--input") == 0) inputPath = argv[i + 1];
+        else if (strcmp(argv[i], "--algorithm") == 0) settings.algorithmType = atoi(argv[i + 1]);
+        else if (strcmp(argv[i], "--depth") == 0) settings.depth = atoi(argv[i + 1]);
+        else if (strcmp(argv[i], "--threads") == 0) threadCount = max(1, atoi(argv[i + 1]));
+        else if (strcmp(argv[i], "--memory") == 0) settings.memoryBudget = size_t(atoi(argv[i + 1])) * 1024 * 1024;
+    }
+    settings.mctsTime = 10;  // short monte carlo searches for large batches
+
+    ios::sync_with_stdio(false);
+    ifstream file;
+    if (!inputPath.empty()) {
+        file.open(inputPath);
+        if (!file) {
+            cerr << "can't open " << inputPath << endl;
+            return 1;
+        }
+    }
+    istream& in = inputPath.empty() ? cin : file;
+
+    mutex chunkMutex;
+    condition_variable chunkReady, chunkDone;
+    deque<shared_ptr<Chunk>> readChunks;   // chunks in input order, until written
+    deque<shared_ptr<Chunk>> waitingChunks;  // chunks not yet taken by a thread
+    bool isInputFinished = false;
+
+    // search threads
+    vector<thread> threads;
+    for (int i = 0; i < threadCount; i++) {
+        threads.emplace_back([&] {
+            unique_lock<mutex> lock(chunkMutex);
+            while (true) {
+                chunkReady.wait(lock, [&] { return isInputFinished || !waitingChunks.empty(); });
+                if (waitingChunks.empty()) return;
+
+                shared_ptr<Chunk> chunk = waitingChunks.front();
+                waitingChunks.pop_front();
+
+                lock.unlock();
+                analyzeChunk(*chunk, settings);
+                lock.lock();
+
+                chunk->isDone = true;
+                chunkDone.notify_all();
+            }
+        });
+    }
+
+    // writes finished chunks from the front, waits while at least minCount chunks are kept
+    auto writeChunks = [&](size_t minCount) {
+        unique_lock<mutex> lock(chunkMutex);
+        while (!readChunks.empty()) {
+            if (!readChunks.front()->isDone) {
+                if (readChunks.size() < minCount) return;
+                chunkDone.wait(lock, [&] { return readChunks.front()->isDone; });
+            }
+
+            shared_ptr<Chunk> chunk = readChunks.front();
+            readChunks.pop_front();
+
+            lock.unlock();
+            cout << chunk->output;
+            lock.lock();
+        }
+    };
+
+    const size_t maxChunks = size_t(threadCount) * CHUNKS_PER_THREAD;
+    long long lineNumber = 1;
+    string line;
+
+    while (in) {
+        auto chunk = make_shared<Chunk>();
+        chunk->firstLine = lineNumber;
+        while (int(chunk->lines.size()) < CHUNK_LINES && getline(in, line)) {
+            chunk->lines.push_back(line);
+        }
+        if (chunk->lines.empty()) break;
+        lineNumber += chunk->lines.size();
+
+        // memory is bounded by the number of chunks read ahead
+        writeChunks(maxChunks);
+
+        lock_guard<mutex> lock(chunkMutex);
+        readChunks.push_back(chunk);
+        waitingChunks.push_back(chunk);
+        chunkReady.notify_one();
+    }
+
+    {
+        lock_guard<mutex> lock(chunkMutex);
+        isInputFinished = true;
+    }
+    chunkReady.notify_all();
+
+    writeChunks(0);
+    for (thread& searchThread : threads) {
+        searchThread.join();
+    }
+
+    cout.flush();
+    return 0;
+}
@@ -0,0 +1,397 @@
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <regex>
+#include <string>
+#include <thread>
+#include "state.h"
+#include "tree.h"
+#include "minimax.h"
+#include "alfabeta.h"
+#include "solver.h"
+#include "mcts.h"
+#include "leafbatch.h"
+
+using namespace std;
+
+/*
+microbenchmarks for state, tree and search functions
+
+usage: bench [--filter text] [--out file] [--baseline file] [--threshold percent]
+results are written in Google Benchmark JSON format, if a baseline is given,
+benchmarks slower than the threshold are reported and exit code is 1
+a baseline is the output of an earlier version, times depend on the machine, so it is
+recorded on the machine that compares, with the release build of the earlier version
+  bench --out baseline.json
+and after the change
+  bench --baseline baseline.json --threshold 10
+bench/baseline.json is a reference recorded with g++ -O2 on one core of a x86-64 Linux
+machine, it only shows large regressions on other machines
+
+usage: bench --strength positions
+compares move quality and time of alfa beta and monte carlo tree search, on random
+positions where some moves lose, a move is optimal if the exact solver gives it the root value
+*/
+
+const double MIN_TIME = 0.1;  // minimal measured seconds per benchmark
+
+volatile long long sink;  // keeps benchmarked results from being optimized away
+
+struct Result {
+    string name;
+    long long iterations;
+    double nanoseconds;  // time per iteration
+};
+
+// benchmark body, runs given iterations and returns measured nanoseconds
+typedef function<double(long long)> Benchmark;
+
+double elapsed(chrono::steady_clock::time_point start) {
+    return chrono::duration<double, nano>(chrono::steady_clock::now() - start).count();
+}
+
+// runs benchmark with growing iteration count until it takes at least MIN_TIME
+Result runBenchmark(string name, Benchmark benchmark) {
+    long long iterations = 1;
+    double nanoseconds = benchmark(iterations);
+
+    while (nanoseconds < MIN_TIME * 1e9) {
+        // estimate iterations needed, grow at most 10 times
+        double factor = nanoseconds > 0 ? MIN_TIME * 1e9 * 1.4 / nanoseconds : 10;
+        iterations = (long long)(iterations * min(max(factor, 2.0), 10.0));
+        nanoseconds = benchmark(iterations);
+    }
+
+    return {name, iterations, nanoseconds / iterations};
+}
+
+// fixed sequence of given length, same on every run
+State sequence(int length) {
+    vector<int> numbers;
+
+    srand(length);
+    for (int i = 0; i < length; i++) {
+        numbers.push_back(rand() % 4 + 1);
+    }
+
+    return State(numbers);
+}
+
+// all benchmarks with their names
+vector<pair<string, Benchmark>> benchmarks() {
+    vector<pair<string, Benchmark>> list;
+    const vector<int> lengths = {15, 20, 30};
+    const vector<int> depths = {3, 5, 7};
+
+    for (int length : lengths) {
+        string suffix = "/" + to_string(length);
+
+        list.push_back({"State::doAction" + suffix, [length](long long iterations) {
+            State state = sequence(length);
+            auto start = chrono::steady_clock::now();
+            for (long long i = 0; i < iterations; i++) {
+                State copy = state;
+                copy.doAction(4, true);
+                copy.doAction(2, i % 2);
+                sink = copy.getPoints();
+            }
+            return elapsed(start);
+        }});
+
+        list.push_back({"State::heuristicValue" + suffix, [length](long long iterations) {
+            State state = sequence(length);
+            auto start = chrono::steady_clock::now();
+            for (long long i = 0; i < iterations; i++) {
+                sink = state.heuristicValue();
+            }
+            return elapsed(start);
+        }});
+
+        list.push_back({"LeafBatch::evaluate" + suffix, [length](long long iterations) {
+            // frontier of 1024 states with counts up to the sequence's counts
+            State state = sequence(length);
+            int oddCount = state.getCount(1) + state.getCount(3);
+            int evenCount = state.getCount(2) + state.getCount(4);
+            LeafBatch batch;
+            for (int i = 0; i < 1024; i++) {
+                batch.add(i % 3, i % 2, i % (oddCount + 1), i % (evenCount + 1));
+            }
+            vector<int> values(batch.size());
+            auto start = chrono::steady_clock::now();
+            for (long long i = 0; i < iterations; i++) {
+                batch.evaluate(values.data());
+                sink = values[i % values.size()];
+            }
+            return elapsed(start);
+        }});
+
+        list.push_back({"Tree::generateChildStates" + suffix, [length](long long iterations) {
+            State state = sequence(length);
+            auto start = chrono::steady_clock::now();
+            for (long long i = 0; i < iterations; i++) {
+                sink = Tree::generateChildStates(state).size();
+            }
+            return elapsed(start);
+        }});
+
+        for (int depth : depths) {
+            string name = suffix + "/" + to_string(depth);
+
+            list.push_back({"Tree::generateTree" + name, [length, depth](long long iterations) {
+                double nanoseconds = 0;
+                for (long long i = 0; i < iterations; i++) {
+                    Tree* tree = new Tree(sequence(length));
+                    auto start = chrono::steady_clock::now();
+                    sink = tree->generateTree(depth);
+                    nanoseconds += elapsed(start);
+                    delete tree;
+                }
+                return nanoseconds;
+            }});
+
+            list.push_back({"Tree::getAllNodes" + name, [length, depth](long long iterations) {
+                Tree tree(sequence(length));
+                tree.generateTree(depth);
+                auto start = chrono::steady_clock::now();
+                for (long long i = 0; i < iterations; i++) {
+                    sink = tree.getAllNodes().size();
+                }
+                return elapsed(start);
+            }});
+
+            list.push_back({"Tree::~Tree" + name, [length, depth](long long iterations) {
+                double nanoseconds = 0;
+                for (long long i = 0; i < iterations; i++) {
+                    Tree* tree = new Tree(sequence(length));
+                    tree->generateTree(depth);
+                    auto start = chrono::steady_clock::now();
+                    delete tree;
+                    nanoseconds += elapsed(start);
+                }
+                return nanoseconds;
+            }});
+
+            list.push_back({"minimax" + name, [length, depth](long long iterations) {
+                Tree tree(sequence(length));
+                int treeDepth = tree.generateTree(depth);
+                int nodeCount = 0;
+                auto start = chrono::steady_clock::now();
+                for (long long i = 0; i < iterations; i++) {
+                    sink = minimax(tree.getRoot(), true, treeDepth, nodeCount);
+                }
+                return elapsed(start);
+            }});
+
+            list.push_back({"Tree::evaluateLeaves" + name, [length, depth](long long iterations) {
+                Tree tree(sequence(length));
+                tree.generateTree(depth);
+                auto start = chrono::steady_clock::now();
+                for (long long i = 0; i < iterations; i++) {
+                    sink = tree.evaluateLeaves();
+                }
+                return elapsed(start);
+            }});
+
+            list.push_back({"alfabeta batch" + name, [length, depth](long long iterations) {
+                Tree tree(sequence(length));
+                int treeDepth = tree.generateTree(depth);
+                tree.evaluateLeaves();
+                int nodeCount = 0;
+                auto start = chrono::steady_clock::now();
+                for (long long i = 0; i < iterations; i++) {
+                    sink = alfabeta(tree.getRoot(), true, treeDepth, MIN, MAX, nodeCount, true);
+                }
+                return elapsed(start);
+            }});
+
+            list.push_back({"alfabeta" + name, [length, depth](long long iterations) {
+                Tree tree(sequence(length));
+                int treeDepth = tree.generateTree(depth);
+                int nodeCount = 0;
+                auto start = chrono::steady_clock::now();
+                for (long long i = 0; i < iterations; i++) {
+                    sink = alfabeta(tree.getRoot(), true, treeDepth, MIN, MAX, nodeCount);
+                }
+                return elapsed(start);
+            }});
+        }
+    }
+
+    return list;
+}
+
+// writes results in Google Benchmark JSON format
+void writeJson(ostream& out, const vector<Result>& results) {
+    out << "{\n  \"benchmarks\": [\n";
+    for (size_t i = 0; i < results.size(); i++) {
+        out << "    {\"name\": \"" << results[i].name << "\", "
+            << "\"iterations\": " << results[i].iterations << ", "
+            << "\"real_time\": " << fixed << setprecision(2) << results[i].nanoseconds << ", "
+            << "\"time_unit\": \"ns\"}"
+            << (i + 1 < results.size() ? "," : "") << "\n";
+    }
+    out << "  ]\n}\n";
+}
+
+// reads benchmark times from a JSON file written by writeJson
+map<string, double> readBaseline(string path) {
+    map<string, double> baseline;
+    ifstream file(path);
+    regex pattern("\"name\": \"([^\"]+)\".*\"real_time\": ([0-9.eE+-]+)");
+    string line;
+    smatch match;
+
+    while (getline(file, line)) {
+        if (regex_search(line, match, pattern))
+            baseline[match[1]] = stod(match[2]);
+    }
+
+    return baseline;
+}
+
+// random positions where not every move has the same exact value
+vector<pair<State, bool>> strengthPositions(int count) {
+    vector<pair<State, bool>> positions;
+
+    srand(count);
+    while (int(positions.size()) < count) {
+        vector<int> numbers;
+        int length = rand() % 26 + 15;
+        for (int i = 0; i < length; i++) {
+            numbers.push_back(rand() % 4 + 1);
+        }
+
+        State state(State(numbers).getNumberMap(), rand() % 2, rand() % 2);
+        bool isMaxPlayer = rand() % 2 == 0;
+        int value = solve(state, isMaxPlayer);
+
+        for (State childState : Tree::generateChildStates(state)) {
+            if (solve(childState, !isMaxPlayer) != value) {
+                positions.push_back({state, isMaxPlayer});
+                break;
+            }
+        }
+    }
+
+    return positions;
+}
+
+// move quality per millisecond of alfa beta at fixed depths and mcts at fixed times
+void runStrength(int positionCount) {
+    typedef function<State(State, bool)> MoveFunction;
+    vector<pair<string, MoveFunction>> players;
+    int threadCount = max(1u, thread::hardware_concurrency());
+
+    for (int depth : {3, 5, 7}) {
+        players.push_back({"alfabeta/" + to_string(depth), [depth](State state, bool isMaxPlayer) {
+            Tree tree(state);
+            int treeDepth = tree.generateTree(depth);
+            int nodeCount = 0;
+            int value = alfabeta(tree.getRoot(), isMaxPlayer, treeDepth, MIN, MAX, nodeCount);
+            for (Node* node : tree.getRoot()->getChildNodes()) {
+                if (node->getValue() == value)
+                    return node->getState();
+            }
+            return state;
+        }});
+    }
+    for (double milliseconds : {1.0, 5.0, 25.0}) {
+        players.push_back({"mcts/" + to_string(int(milliseconds)) + "ms", [milliseconds, threadCount](State state, bool isMaxPlayer) {
+            MctsSearch search;
+            return search.search(state, isMaxPlayer, milliseconds, threadCount);
+        }});
+    }
+
+    vector<pair<State, bool>> positions = strengthPositions(positionCount);
+
+    cout << positions.size() << " positions, mcts threads " << threadCount << endl;
+    cout << left << setw(16) << "engine" << right << setw(12) << "ms/move" << setw(12) << "optimal"
+         << setw(16) << "optimal %/ms" << endl;
+
+    for (const auto& player : players) {
+        int optimalCount = 0;
+        double nanoseconds = 0;
+
+        for (const auto& position : positions) {
+            auto start = chrono::steady_clock::now();
+            State bestState = player.second(position.first, position.second);
+            nanoseconds += elapsed(start);
+
+            if (solve(bestState, !position.second) == solve(position.first, position.second))
+                optimalCount++;
+        }
+
+        double milliseconds = nanoseconds / 1e6 / positions.size();
+        double optimal = optimalCount * 100.0 / positions.size();
+        cout << left << setw(16) << player.first << right << fixed << setprecision(3)
+             << setw(12) << milliseconds << setw(11) << setprecision(1) << optimal << "%"
+             << setw(16) << setprecision(2) << optimal / milliseconds << endl;
+    }
+}
+
+int main(int argc, char *argv[]) {
+    string filter, outPath, baselinePath;
+    double threshold = 10;  // allowed slowdown in percent
+    int strengthCount = 0;  // positions in strength comparison
+
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (strcmp(argv[i], "--filter") == 0) filter = argv[i + 1];
+        else if (strcmp(argv[i], "--out") == 0) outPath = argv[i + 1];
+        else if (strcmp(argv[i], "--baseline") == 0) baselinePath = argv[i + 1];
+        else if (strcmp(argv[i], "--threshold") == 0) threshold = atof(argv[i + 1]);
+        else if (strcmp(argv[i], "--strength") == 0) strengthCount = atoi(argv[i + 1]);
+    }
+
+    if (strengthCount > 0) {
+        runStrength(strengthCount);
+        return 0;
+    }
+
+    map<string, double> baseline;
+    if (!baselinePath.empty()) {
+        baseline = readBaseline(baselinePath);
+        if (baseline.empty()) {
+            cerr << "no benchmarks in " << baselinePath << endl;
+            return 1;
+        }
+    }
+
+    vector<Result> results;
+    int regressionCount = 0;
+
+    for (const auto& benchmark : benchmarks()) {
+        if (benchmark.first.find(filter) == string::npos) continue;
+
+        Result result = runBenchmark(benchmark.first, benchmark.second);
+        results.push_back(result);
+
+        cout << left << setw(36) << result.name << right << setw(14) << fixed << setprecision(1)
+             << result.nanoseconds << " ns" << setw(12) << result.iterations;
+
+        // compare with baseline
+        auto stored = baseline.find(result.name);
+        if (stored != baseline.end() && stored->second > 0) {
+            double change = (result.nanoseconds / stored->second - 1) * 100;
+            cout << setw(10) << showpos << setprecision(1) << change << "%" << noshowpos;
+            if (change > threshold) {
+                cout << "  REGRESSION";
+                regressionCount++;
+            }
+        }
+        cout << endl;
+    }
+
+    if (!outPath.empty()) {
+        ofstream out(outPath);
+        writeJson(out, results);
+    }
+
+    if (!baseline.empty())
+        cout << regressionCount << " regressions over " << threshold << "%" << endl;
+
+    return regressionCount > 0 ? 1 : 0;
+}
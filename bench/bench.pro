@@ -0,0 +1,27 @@
+TEMPLATE = app
+TARGET = bench
+
+QT -= core gui
+
+CONFIG += c++17 console
+CONFIG -= app_bundle
+
+# solution table in table.h is generated at compile time
+msvc: QMAKE_CXXFLAGS += /constexpr:steps10000000
+
+INCLUDEPATH += ..
+
+SOURCES += \
+    bench.cpp
+
+HEADERS += \
+    ../alfabeta.h \
+    ../external.h \
+    ../leafbatch.h \
+    ../mcts.h \
+    ../minimax.h \
+    ../solver.h \
+    ../state.h \
+    ../table.h \
+    ../trace.h \
+    ../tree.h
@@ -0,0 +1,283 @@
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <iomanip>
+#include <sstream>
+#include "engine.h"
+#include "engines.h"
+#include "dfpn.h"
+
+using namespace std;
+
+/*
+differential check of all search engines against the reference search
+
+usage: check [--length N] [--depth D] [--samples K] [--seed S] [--directory dir]
+without samples all number counts up to length N are checked, otherwise K random
+sequences up to length N, every position is searched to depths 1..D and to full depth
+reference is minimax over the tree, for full depth exhaustive minimax with cache,
+as the full tree is only feasible for very short sequences
+proof-number search solves getWinner results instead of heuristic values, so it is
+checked only at full depth against an exhaustive search of getWinner results, and on
+positions with counts too large for packed states, which it has to leave unproven, so
+the game's df-pn algorithm plays the alfa-beta move instead
+
+speed is compared on the positions both searches ran on, against the minimax engine
+(same tree search at the same depth) and, at full depth, against the cached exhaustive
+search, which gets faster as its cache fills
+*/
+
+const int FULL_TREE_LENGTH = 3;  // longest sequence searched to full depth with a tree
+
+struct Position {
+    State state;
+    bool isMaxPlayer;
+    int depth;
+};
+
+struct EngineStats {
+    int positionCount = 0;
+    int valueErrorCount = 0;
+    int moveErrorCount = 0;
+    double time = 0;  // engine time in seconds
+
+    // minimax engine's time and this engine's time on positions both ran on
+    double minimaxTime = 0, timeOnMinimax = 0;
+    // exhaustive search's time and this engine's time on full depth positions
+    double exhaustiveTime = 0, timeOnExhaustive = 0;
+};
+
+// time ratio of reference to engine, negative if they had no common positions
+double speedup(double referenceTime, double time) {
+    return time > 0 ? referenceTime / time : -1;
+}
+
+// speedup column, "-" if there is no ratio
+string speedupText(double speedup) {
+    if (speedup < 0) return "-";
+    ostringstream text;
+    text << fixed << setprecision(2) << speedup << "x";
+    return text.str();
+}
+
+double elapsed(chrono::steady_clock::time_point start) {
+    return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+}
+
+int stateLength(State state) {
+    return int(state.getNumbers().size());
+}
+
+// positions with every number count up to given length
+vector<Position> enumeratePositions(int maxLength, int maxDepth) {
+    vector<Position> positions;
+
+    for (int length = 1; length <= maxLength; length++) {
+        for (int ones = 0; ones <= length; ones++) {
+            for (int twos = 0; ones + twos <= length; twos++) {
+                for (int threes = 0; ones + twos + threes <= length; threes++) {
+                    map<int, int> numbers = {{1, ones}, {2, twos}, {3, threes}, {4, length - ones - twos - threes}};
+                    for (int parity = 0; parity < 4; parity++) {
+                        for (bool isMaxPlayer : {true, false}) {
+                            for (int depth = 1; depth <= maxDepth + 1; depth++) {
+                                State state(numbers, parity / 2, parity % 2);
+                                positions.push_back({state, isMaxPlayer, depth > maxDepth ? -1 : depth});
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    return positions;
+}
+
+// random positions up to given length
+vector<Position> samplePositions(int maxLength, int maxDepth, int sampleCount) {
+    vector<Position> positions;
+
+    for (int i = 0; i < sampleCount; i++) {
+        vector<int> numbers;
+        int length = rand() % maxLength + 1;
+        for (int j = 0; j < length; j++) {
+            numbers.push_back(rand() % 4 + 1);
+        }
+
+        map<int, int> counts = State(numbers).getNumberMap();
+        State state(counts, rand() % 2, rand() % 2);
+        int depth = rand() % (maxDepth + 1) + 1;
+        positions.push_back({state, rand() % 2 == 0, depth > maxDepth ? -1 : depth});
+    }
+
+    return positions;
+}
+
+int main(int argc, char *argv[]) {
+    int maxLength = 5, maxDepth = 5, sampleCount = 0;
+    unsigned seed = 1;
+    string directory = ".";
+
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (strcmp(argv[i], "--length") == 0) maxLength = atoi(argv[i + 1]);
+        else if (strcmp(argv[i], "--depth") == 0) maxDepth = atoi(argv[i + 1]);
+        else if (strcmp(argv[i], "--samples") == 0) sampleCount = atoi(argv[i + 1]);
+        else if (strcmp(argv[i], "--seed") == 0) seed = atoi(argv[i + 1]);
+        else if (strcmp(argv[i], "--directory") == 0) directory = argv[i + 1];
+    }
+
+    // external engine keeps its levels in the directory, which has to be writable
+    ExternalAnalysis directoryCheck(directory, 1 << 20);
+    if (directoryCheck.analyze(State(vector<int>{1}), true) == ExternalAnalysis::FILE_ERROR) {
+        cerr << directoryCheck.getError() << endl;
+        return 1;
+    }
+
+    srand(seed);
+    vector<Position> positions = sampleCount > 0
+        ? samplePositions(maxLength, maxDepth, sampleCount)
+        : enumeratePositions(maxLength, maxDepth);
+
+    vector<Engine> engines = getEngines(directory);
+    vector<EngineStats> stats(engines.size());
+    map<pair<State, bool>, int> cache;  // exhaustive minimax values
+    map<pair<State, bool>, int> winnerCache;  // exhaustive getWinner results
+    ProofNumberSearch proofSearch;
+    EngineStats proofStats;
+
+    for (Position position : positions) {
+        bool isFullDepth = position.depth == -1;
+        bool isTreeFeasible = !isFullDepth || stateLength(position.state) <= FULL_TREE_LENGTH;
+
+        // reference value of root and of every child
+        auto start = chrono::steady_clock::now();
+        int value;
+        map<State, int> childValues;
+        if (isFullDepth) {
+            value = exhaustiveMinimax(position.state, position.isMaxPlayer, cache);
+            for (State childState : Tree::generateChildStates(position.state)) {
+                childValues[childState] = exhaustiveMinimax(childState, !position.isMaxPlayer, cache);
+            }
+        } else {
+            Tree tree(position.state);
+            int treeDepth = tree.generateTree(position.depth);
+            int nodeCount = 0;
+            value = minimax(tree.getRoot(), position.isMaxPlayer, treeDepth, nodeCount);
+            for (Node* node : tree.getRoot()->getChildNodes()) {
+                childValues[node->getState()] = node->getValue();
+            }
+        }
+        double referenceTime = elapsed(start);
+        double minimaxTime = -1;  // time of the minimax engine, first engine, if it ran
+
+        for (size_t i = 0; i < engines.size(); i++) {
+            if (engines[i].isFullDepthOnly && !isFullDepth) continue;
+            if (engines[i].usesTree && !isTreeFeasible) continue;
+
+            start = chrono::steady_clock::now();
+            SearchResult result = engines[i].search(position.state, position.isMaxPlayer, position.depth);
+            double time = elapsed(start);
+            if (i == 0) minimaxTime = time;
+
+            stats[i].time += time;
+            stats[i].positionCount++;
+            if (minimaxTime >= 0) {
+                stats[i].minimaxTime += minimaxTime;
+                stats[i].timeOnMinimax += time;
+            }
+            if (isFullDepth) {
+                stats[i].exhaustiveTime += referenceTime;
+                stats[i].timeOnExhaustive += time;
+            }
+
+            // best move has to be legal and lead to a child with the root value
+            bool isFinished = position.state.hasFinished();
+            auto child = childValues.find(result.bestState);
+            bool isMoveCorrect = isFinished || (child != childValues.end() && child->second == value);
+
+            if (result.value != value) stats[i].valueErrorCount++;
+            if (!isMoveCorrect) stats[i].moveErrorCount++;
+
+            if (result.value != value || !isMoveCorrect) {
+                map<int, int> numbers = position.state.getNumberMap();
+                cout << engines[i].name << " mismatch: "
+                     << numbers[1] << " " << numbers[2] << " " << numbers[3] << " " << numbers[4]
+                     << " points " << position.state.getPoints() << " bank " << position.state.getBank()
+                     << (position.isMaxPlayer ? " max" : " min") << " depth " << position.depth
+                     << " value " << result.value << " expected " << value
+                     << (isMoveCorrect ? "" : " wrong move") << endl;
+            }
+        }
+
+        if (isFullDepth) {
+            start = chrono::steady_clock::now();
+            int winner = exhaustiveWinner(position.state, position.isMaxPlayer, winnerCache);
+            proofStats.exhaustiveTime += elapsed(start);
+
+            start = chrono::steady_clock::now();
+            int provenWinner = proofSearch.solve(position.state, position.isMaxPlayer);
+            State bestState = proofSearch.solveMove(position.state, position.isMaxPlayer);
+            double time = elapsed(start);
+            proofStats.time += time;
+            proofStats.timeOnExhaustive += time;
+            proofStats.positionCount++;
+
+            bool isMoveCorrect = exhaustiveWinner(bestState, !position.isMaxPlayer, winnerCache) == winner;
+            if (provenWinner != winner) proofStats.valueErrorCount++;
+            if (!isMoveCorrect) proofStats.moveErrorCount++;
+
+            if (provenWinner != winner || !isMoveCorrect) {
+                map<int, int> numbers = position.state.getNumberMap();
+                cout << "dfpn mismatch: "
+                     << numbers[1] << " " << numbers[2] << " " << numbers[3] << " " << numbers[4]
+                     << " points " << position.state.getPoints() << " bank " << position.state.getBank()
+                     << (position.isMaxPlayer ? " max" : " min")
+                     << " winner " << provenWinner << " expected " << winner
+                     << (isMoveCorrect ? "" : " wrong move") << endl;
+            }
+        }
+    }
+
+    // counts above PACKED_COUNT_MAX would overflow packed states
+    vector<map<int, int>> largeCounts = {{{1, 40000}}, {{2, 20000}}, {{4, 9000}}, {{1, 1}, {3, 32767}}};
+    for (map<int, int> numbers : largeCounts) {
+        State state(numbers, 0, 0);
+        SearchSettings settings;
+        settings.depth = 3;
+        MoveResult fallback = searchMove(state, true, settings);
+        settings.algorithmType = 5;
+
+        auto start = chrono::steady_clock::now();
+        int provenWinner = proofSearch.solve(state, true);
+        MoveResult result = searchMove(state, true, settings);
+        proofStats.time += elapsed(start);
+        proofStats.positionCount++;
+
+        if (provenWinner != 0) proofStats.valueErrorCount++;
+        if (!(result.bestState == fallback.bestState) || result.value != fallback.value) proofStats.moveErrorCount++;
+        if (provenWinner != 0 || !(result.bestState == fallback.bestState))
+            cout << "dfpn large counts: " << numbers[1] << " " << numbers[2] << " " << numbers[3] << " "
+                 << numbers[4] << " winner " << provenWinner << " expected unproven" << endl;
+    }
+
+    engines.push_back({"dfpn", true, false, nullptr});
+    stats.push_back(proofStats);
+
+    // summary
+    int errorCount = 0;
+    cout << positions.size() << " positions" << endl;
+    cout << left << setw(12) << "engine" << right << setw(10) << "positions" << setw(10) << "values"
+         << setw(10) << "moves" << setw(12) << "time s" << setw(14) << "vs minimax"
+         << setw(16) << "vs exhaustive" << endl;
+    for (size_t i = 0; i < engines.size(); i++) {
+        cout << left << setw(12) << engines[i].name << right << setw(10) << stats[i].positionCount
+             << setw(10) << stats[i].valueErrorCount << setw(10) << stats[i].moveErrorCount
+             << setw(12) << fixed << setprecision(4) << stats[i].time
+             << setw(14) << speedupText(speedup(stats[i].minimaxTime, stats[i].timeOnMinimax))
+             << setw(16) << speedupText(speedup(stats[i].exhaustiveTime, stats[i].timeOnExhaustive)) << endl;
+        errorCount += stats[i].valueErrorCount + stats[i].moveErrorCount;
+    }
+
+    return errorCount > 0 ? 1 : 0;
+}
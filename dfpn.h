@@ -0,0 +1,306 @@
+#ifndef DFPN_H
+#define DFPN_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <vector>
+#include "state.h"
+#include "tree.h"
+#include "external.h"
+
+using namespace std;
+
+/*
+depth-first proof-number search (df-pn) for the exact game result
+
+unlike heuristicValue, getWinner has only three results, so the game can be solved as
+two yes/no questions for player 1 (max player): can it win, and can it at least draw
+proof and disproof numbers lead the search to the moves that are quickest to prove,
+so only a fraction of the full tree is visited
+results are kept in a bounded transposition table, entries with the least work are replaced
+when it is full, the game has no cycles, so lost entries only cost repeated search
+with a table too small for the game the same work is lost again and again, so every
+question has a node limit, after which the result is unknown, and the whole search can
+have a time limit, which the game uses to keep moves interactive
+*/
+class ProofNumberSearch {
+private:
+    static constexpr uint32_t INFINITE = 1u << 30;  // proof number of a disproven node
+
+    // questions proven for max player
+    static const int TARGET_WIN = 0;   // max player wins
+    static const int TARGET_DRAW = 1;  // max player wins or draws
+
+    struct Entry {
+        uint64_t key;       // packed state, player and target
+        uint32_t proof;     // proof number
+        uint32_t disproof;  // disproof number
+        uint64_t work;      // searched nodes, 0 if entry is empty
+    };
+
+    vector<Entry> table;  // buckets of two entries
+    size_t tableMask;     // bucket count - 1
+    size_t tableSize;     // used entries
+    long long nodeCount;  // searched nodes
+    long long nodeLimit;  // nodes per proven question, 0 for no limit
+    long long stopCount;  // node count at which current question is given up
+    bool isAborted;       // current question reached node limit or was stopped
+    const atomic<bool>* stopFlag = nullptr;
+    bool hasDeadline = false;
+    chrono::steady_clock::time_point deadline;
+    int terminalWinners[4];  // getWinner by points and bank parity
+
+    static uint64_t makeKey(PackedState state, bool isMaxPlayer, int target) {
+        return (state << 2) | (uint64_t(isMaxPlayer) << 1) | uint64_t(target);
+    }
+
+    // mixes all key bits, states differ mostly in high count bits
+    size_t bucketIndex(uint64_t key) const {
+        key ^= key >> 33;
+        key *= 0xff51afd7ed558ccdULL;
+        key ^= key >> 33;
+        return key & tableMask;
+    }
+
+    Entry* find(uint64_t key) {
+        size_t bucket = bucketIndex(key);
+        for (int i = 0; i < 2; i++) {
+            Entry& entry = table[bucket * 2 + i];
+            if (entry.work > 0 && entry.key == key) return &entry;
+        }
+        return nullptr;
+    }
+
+    void store(uint64_t key, uint32_t proof, uint32_t disproof, uint64_t work) {
+        size_t bucket = bucketIndex(key);
+        Entry* first = &table[bucket * 2];
+        Entry* second = first + 1;
+
+        // same key, else empty entry, else entry with less work
+        Entry* entry = first->key == key && first->work > 0 ? first
+                     : second->key == key && second->work > 0 ? second
+                     : first->work <= second->work ? first : second;
+
+        if (entry->work == 0) tableSize++;
+        *entry = {key, proof, disproof, max<uint64_t>(work, 1)};
+    }
+
+    // proof and disproof numbers from table, unknown states are 1, 1
+    void lookup(PackedState state, bool isMaxPlayer, int target, uint32_t& proof, uint32_t& disproof) {
+        if (isPackedFinished(state)) {
+            bool isProven = isTargetReached(state, target);
+            proof = isProven ? 0 : INFINITE;
+            disproof = isProven ? INFINITE : 0;
+            return;
+        }
+
+        Entry* entry = find(makeKey(state, isMaxPlayer, target));
+        proof = entry ? entry->proof : 1;
+        disproof = entry ? entry->disproof : 1;
+    }
+
+    bool isTargetReached(PackedState state, int target) const {
+        int winner = terminalWinners[state & 3];
+        return winner == 1 || (target == TARGET_DRAW && winner == 3);
+    }
+
+    static uint32_t add(uint32_t a, uint32_t b) {
+        return min(a + b, INFINITE);
+    }
+
+    /*
+    multiple iterative deepening at one node
+    phi and delta are proof and disproof numbers from the view of the player to move,
+    max player nodes are OR nodes (phi = proof), min player nodes are AND nodes (phi = disproof)
+    node is searched until phi or delta reaches its limit
+    */
+    void mid(PackedState state, bool isMaxPlayer, int target, uint32_t phiLimit, uint32_t deltaLimit) {
+        long long startCount = nodeCount++;
+        uint64_t key = makeKey(state, isMaxPlayer, target);
+
+        PackedState children[6];
+        int childCount = packedChildStates(state, children);
+
+        uint32_t phi, delta;
+        while (true) {
+            // phi is the smallest child delta
+            // delta is the largest child phi plus other open children, a sum of child phis
+            // would count states reached by several move orders many times
+            int bestChild = 0;
+            uint32_t bestDelta = INFINITE, secondDelta = INFINITE, bestPhi = 0;
+            uint32_t maxPhi = 0, openCount = 0;
+
+            for (int i = 0; i < childCount; i++) {
+                uint32_t proof, disproof;
+                lookup(children[i], !isMaxPlayer, target, proof, disproof);
+                uint32_t childPhi = isMaxPlayer ? disproof : proof;
+                uint32_t childDelta = isMaxPlayer ? proof : disproof;
+
+                maxPhi = max(maxPhi, childPhi);
+                if (childPhi > 0) openCount++;
+                if (childDelta < bestDelta) {
+                    secondDelta = bestDelta;
+                    bestDelta = childDelta;
+                    bestPhi = childPhi;
+                    bestChild = i;
+                } else if (childDelta < secondDelta) {
+                    secondDelta = childDelta;
+                }
+            }
+            phi = bestDelta;
+            delta = maxPhi > 0 ? add(maxPhi, openCount - 1) : 0;
+
+            if (phi >= phiLimit || delta >= deltaLimit) break;
+
+            // numbers so far are still valid bounds, so they are stored
+            // clock is read every 1024 nodes
+            if (isAborted || (nodeLimit > 0 && nodeCount >= stopCount) ||
+                (stopFlag && stopFlag->load(memory_order_relaxed)) ||
+                (hasDeadline && (nodeCount & 1023) == 0 && chrono::steady_clock::now() >= deadline)) {
+                isAborted = true;
+                break;
+            }
+
+            // search best child until it is no longer best or limits are reached
+            // second best limit is raised by a quarter, so search switches between children less
+            uint32_t childPhiLimit = deltaLimit - delta + bestPhi;
+            uint32_t childDeltaLimit = min(phiLimit, add(secondDelta, secondDelta / 4 + 1));
+            mid(children[bestChild], !isMaxPlayer, target,
+                min(childPhiLimit, INFINITE), childDeltaLimit);
+        }
+
+        uint32_t proof = isMaxPlayer ? phi : delta;
+        uint32_t disproof = isMaxPlayer ? delta : phi;
+        store(key, proof, disproof, nodeCount - startCount);
+    }
+
+    // proves or disproves target for state
+    // returns 1 if proven, 0 if disproven, -1 if node limit was reached first
+    int prove(PackedState state, bool isMaxPlayer, int target) {
+        uint32_t proof, disproof;
+        lookup(state, isMaxPlayer, target, proof, disproof);
+
+        stopCount = nodeCount + nodeLimit;
+        isAborted = false;
+        while (proof != 0 && disproof != 0) {
+            mid(state, isMaxPlayer, target, INFINITE, INFINITE);
+            if (isAborted) return -1;
+            lookup(state, isMaxPlayer, target, proof, disproof);
+        }
+
+        return proof == 0;
+    }
+
+    // getWinner result with optimal play, 0 if unknown
+    int result(PackedState state, bool isMaxPlayer) {
+        int isWin = prove(state, isMaxPlayer, TARGET_WIN);
+        if (isWin < 0) return 0;
+        if (isWin) return 1;
+
+        int isDraw = prove(state, isMaxPlayer, TARGET_DRAW);
+        if (isDraw < 0) return 0;
+        return isDraw ? 3 : 2;
+    }
+
+public:
+    // memory budget in bytes for the transposition table
+    // node limit for one question, 0 for no limit, by default 256 nodes per table entry
+    ProofNumberSearch(size_t memoryBudget = 64 << 20, long long nodeLimit = -1) {
+        size_t buckets = 1;
+        while (buckets * 4 * sizeof(Entry) <= memoryBudget) {
+            buckets *= 2;
+        }
+
+        table.resize(buckets * 2);
+        tableMask = buckets - 1;
+        tableSize = 0;
+        nodeCount = 0;
+        this->nodeLimit = nodeLimit >= 0 ? nodeLimit : 256 * (long long)table.size();
+        stopCount = 0;
+        isAborted = false;
+
+        for (int parity = 0; parity < 4; parity++) {
+            terminalWinners[parity] = State(map<int, int>(), parity >> 1, parity & 1).getWinner();
+        }
+    }
+
+    /*
+    returns game result as in getWinner, max player is player 1
+    0 = unknown, node or time limit was reached, search was stopped or counts don't fit packed states
+    1 = player 1
+    2 = player 2
+    3 = draw
+    */
+    int solve(State state, bool isMaxPlayer) {
+        if (!isPackable(state)) return 0;
+        return result(packState(state), isMaxPlayer);
+    }
+
+    // returns state after the first move that keeps the proven result
+    // returns state itself if the result is unknown
+    State solveMove(State state, bool isMaxPlayer) {
+        if (!isPackable(state)) return state;
+        PackedState root = packState(state);
+        if (isPackedFinished(root)) return state;
+
+        int rootResult = result(root, isMaxPlayer);
+        if (rootResult == 0) return state;
+
+        PackedState children[6];
+        int childCount = packedChildStates(root, children);
+
+        for (int i = 0; i < childCount; i++) {
+            if (result(children[i], !isMaxPlayer) == rootResult)
+                return Tree::generateChildStates(state)[i];
+        }
+
+        return state;
+    }
+
+    // setting stopFlag from another thread ends the search with unknown result
+    void setStopFlag(const atomic<bool>* stopFlag) {
+        this->stopFlag = stopFlag;
+    }
+
+    // search gives up with unknown result after given time in milliseconds from now
+    void setTimeLimit(double milliseconds) {
+        hasDeadline = true;
+        deadline = chrono::steady_clock::now() +
+                   chrono::duration_cast<chrono::steady_clock::duration>(chrono::duration<double, milli>(milliseconds));
+    }
+
+    void clear() {
+        fill(table.begin(), table.end(), Entry{0, 0, 0, 0});
+        tableSize = 0;
+    }
+
+    long long getNodeCount() const { return nodeCount; }
+    size_t getTableSize() const { return tableSize; }
+    size_t getMemorySize() const { return table.size() * sizeof(Entry); }
+};
+
+// full search of getWinner result over state graph, values of repeated states are cached
+// reference for ProofNumberSearch
+inline int exhaustiveWinner(State state, bool isMaxPlayer, map<pair<State, bool>, int>& cache) {
+    if (state.hasFinished())
+        return state.getWinner();
+
+    auto result = cache.find({state, isMaxPlayer});
+    if (result != cache.end())
+        return result->second;
+
+    // results ordered for max player
+    const int rank[4] = {0, 2, 0, 1};
+    int bestWinner = 0;
+    for (State childState : Tree::generateChildStates(state)) {
+        int winner = exhaustiveWinner(childState, !isMaxPlayer, cache);
+        if (bestWinner == 0 || (isMaxPlayer ? rank[winner] > rank[bestWinner] : rank[winner] < rank[bestWinner]))
+            bestWinner = winner;
+    }
+
+    cache.emplace(make_pair(state, isMaxPlayer), bestWinner);
+    return bestWinner;
+}
+
+#endif // DFPN_H
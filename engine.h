@@ -0,0 +1,142 @@
+#ifndef ENGINE_H
+#define ENGINE_H
+
+#include <chrono>
+#include <climits>
+#include <cmath>
+#include "state.h"
+#include "tree.h"
+#include "minimax.h"
+#include "alfabeta.h"
+#include "solver.h"
+#include "mcts.h"
+#include "dfpn.h"
+
+using namespace std;
+
+/*
+computer's move search without Qt or global state
+every search counts its own nodes, so searches of different games can run in parallel
+*/
+
+// algorithm and limits of computer's move search
+struct SearchSettings {
+    // 1 = minimax
+    // 2 = alfa-beta
+    // 3 = exact solver
+    // 4 = monte carlo tree search
+    // 5 = proof-number search, alfa-beta when the result can't be proven
+    int algorithmType = 2;
+    int depth = 5;             // tree depth, -1 for full depth
+    size_t memoryBudget = 0;   // tree memory limit in bytes, 0 for no limit
+    double mctsTime = 1000;    // monte carlo tree search time per move in milliseconds
+    int mctsThreads = 1;       // monte carlo tree search threads
+    size_t proofTableSize = 16 << 20;  // proof-number table size in bytes
+    double proofTime = 1000;           // proof-number search time limit per move in milliseconds
+};
+
+// result of computer's move search
+struct MoveResult {
+    State bestState;
+    int value;    // root value, monte carlo tree search gives rounded expected result
+    double time;  // search time in seconds
+    int treeDepth, nodeCount;
+    size_t treeMemory;
+    bool isStopped;  // search was stopped, best state and value are not reliable
+};
+
+// searches computer's move from given state
+// setting stopFlag from another thread ends the search early
+inline MoveResult searchMove(State state, bool isMaxPlayer, const SearchSettings& settings,
+                             const atomic<bool>* stopFlag = nullptr) {
+    TRACE_ZONE("searchMove", settings.algorithmType);
+    MoveResult result;
+
+    result.bestState = state;  // end state has no moves
+    result.value = state.heuristicValue();
+    result.treeDepth = 0;
+    result.treeMemory = 0;
+    result.nodeCount = 0;
+
+    // wall clock time, clock() adds up all threads of the process
+    auto startTime = chrono::steady_clock::now();
+
+    if (settings.algorithmType == 3) {
+        // exact solver, no tree needed
+        // precomputed table for standard lengths, parity rules otherwise
+        if (isInSolutionTable(state)) {
+            result.bestState = tableMove(state, isMaxPlayer);
+            result.value = tableValue(state, isMaxPlayer);
+        } else {
+            result.bestState = solveMove(state, isMaxPlayer);
+            result.value = solve(state, isMaxPlayer);
+        }
+    } else if (settings.algorithmType == 5) {
+        // proves the game result, which is not the heuristic value minimax plays for
+        // own small table, the tree memory budget would make every move allocate and clear it
+        ProofNumberSearch search(settings.proofTableSize);
+        search.setStopFlag(stopFlag);
+        search.setTimeLimit(settings.proofTime);
+        int winner = search.solve(state, isMaxPlayer);
+        if (winner != 0) {
+            result.bestState = search.solveMove(state, isMaxPlayer);
+        }
+
+        // solveMove may not prove a move either, then the state is unchanged
+        if (winner == 0 || result.bestState == state) {
+            SearchSettings fallback = settings;
+            fallback.algorithmType = 2;
+            result = searchMove(state, isMaxPlayer, fallback, stopFlag);
+        } else {
+            const int values[4] = {0, 10, -10, 0};
+            result.value = values[winner];
+            result.treeMemory = search.getMemorySize();
+        }
+        result.nodeCount += int(min<long long>(search.getNodeCount(), INT_MAX));
+    } else if (settings.algorithmType == 4 && !isPackable(state)) {
+        // counts too large for packed states, alfa-beta only searches a few levels
+        SearchSettings fallback = settings;
+        fallback.algorithmType = 2;
+        result = searchMove(state, isMaxPlayer, fallback, stopFlag);
+    } else if (settings.algorithmType == 4) {
+        MctsSearch search(settings.memoryBudget);
+        result.bestState = search.search(state, isMaxPlayer, settings.mctsTime, settings.mctsThreads, 0, 1, stopFlag);
+        result.treeMemory = search.getMemorySize();
+        result.nodeCount = search.getNodeCount();
+        result.value = int(lround(search.getValue()));
+    } else {
+        // generate tree, depth may be lower if memory budget is reached
+        Tree tree(state);
+        result.treeDepth = tree.generateTree(settings.depth, settings.memoryBudget, stopFlag);
+        result.treeMemory = tree.getPeakMemoryUsage();
+        tree.evaluateLeaves();
+
+        int optimalValue;
+
+        // use minimax or alfa-beta
+        if (settings.algorithmType == 1) {
+            TRACE_ZONE("minimax", result.treeDepth);
+            optimalValue = minimax(tree.getRoot(), isMaxPlayer, result.treeDepth, result.nodeCount, true, stopFlag);
+        } else {
+            TRACE_ZONE("alfabeta", result.treeDepth);
+            optimalValue = alfabeta(tree.getRoot(), isMaxPlayer, result.treeDepth, MIN, MAX, result.nodeCount, true, stopFlag);
+        }
+
+        result.value = optimalValue;
+
+        // finds next computer state
+        for (Node* node : tree.getRoot()->getChildNodes()) {
+            // if child nodes value matches algorithms found value, state found
+            if (node->getValue() == optimalValue) {
+                result.bestState = node->getState();
+                break;
+            }
+        }
+    }
+
+    result.time = chrono::duration<double>(chrono::steady_clock::now() - startTime).count();
+    result.isStopped = stopFlag && stopFlag->load();
+    return result;
+}
+
+#endif // ENGINE_H
@@ -0,0 +1,110 @@
+#ifndef ENGINES_H
+#define ENGINES_H
+
+#include <functional>
+#include <string>
+#include "tree.h"
+#include "minimax.h"
+#include "alfabeta.h"
+#include "solver.h"
+#include "table.h"
+#include "external.h"
+#include "analysis.h"
+
+using namespace std;
+
+// search result, root value and state after the chosen move
+struct SearchResult {
+    int value;
+    State bestState;
+};
+
+// searches state to given depth, -1 for full depth
+typedef function<SearchResult(State, bool, int)> SearchFunction;
+
+struct Engine {
+    string name;
+    bool isFullDepthOnly;  // ignores depth, only comparable with full depth search
+    bool usesTree;         // builds a tree, full depth is feasible only for short sequences
+    SearchFunction search;
+};
+
+// first child with the optimal value, as in computerMove
+inline State findBestState(Node* root, int optimalValue) {
+    for (Node* node : root->getChildNodes()) {
+        if (node->getValue() == optimalValue)
+            return node->getState();
+    }
+
+    return root->getState();
+}
+
+inline SearchResult minimaxSearch(State state, bool isMaxPlayer, int depth) {
+    Tree tree(state);
+    int treeDepth = tree.generateTree(depth);
+    int nodeCount = 0;
+    int value = minimax(tree.getRoot(), isMaxPlayer, treeDepth, nodeCount);
+    return {value, findBestState(tree.getRoot(), value)};
+}
+
+inline SearchResult alfabetaSearch(State state, bool isMaxPlayer, int depth) {
+    Tree tree(state);
+    int treeDepth = tree.generateTree(depth);
+    int nodeCount = 0;
+    int value = alfabeta(tree.getRoot(), isMaxPlayer, treeDepth, MIN, MAX, nodeCount);
+    return {value, findBestState(tree.getRoot(), value)};
+}
+
+// leaf values of the whole tree are evaluated in one batch before the search
+inline SearchResult batchSearch(State state, bool isMaxPlayer, int depth) {
+    Tree tree(state);
+    int treeDepth = tree.generateTree(depth);
+    tree.evaluateLeaves();
+    int nodeCount = 0;
+    int value = alfabeta(tree.getRoot(), isMaxPlayer, treeDepth, MIN, MAX, nodeCount, true);
+    return {value, findBestState(tree.getRoot(), value)};
+}
+
+// multi-PV analysis of the hint, root value is the best move value
+// best move is the first with that value, moves are in tree child order
+inline SearchResult multiPvSearch(State state, bool isMaxPlayer, int depth) {
+    MultiPvSearch search;
+    vector<MoveValue> moves = search.analyze(state, isMaxPlayer, depth);
+    if (moves.empty()) return {state.heuristicValue(), state};
+
+    MoveValue best = moves[0];
+    for (const MoveValue& move : moves) {
+        if (isMaxPlayer ? move.value > best.value : move.value < best.value)
+            best = move;
+    }
+
+    State bestState = state;
+    bestState.doAction(best.number, best.divide);
+    return {best.value, bestState};
+}
+
+// all search engines, first one is the reference
+// directory is used by engines that keep data on disk
+inline vector<Engine> getEngines(string directory = ".") {
+    return {
+        {"minimax", false, true, minimaxSearch},
+        {"alfabeta", false, true, alfabetaSearch},
+        {"batch", false, true, batchSearch},
+        {"multipv", false, false, multiPvSearch},
+        {"solver", true, false, [](State state, bool isMaxPlayer, int) -> SearchResult {
+            return {solve(state, isMaxPlayer), solveMove(state, isMaxPlayer)};
+        }},
+        {"table", true, false, [](State state, bool isMaxPlayer, int) -> SearchResult {
+            if (!isInSolutionTable(state))
+                return {solve(state, isMaxPlayer), solveMove(state, isMaxPlayer)};
+            return {tableValue(state, isMaxPlayer), tableMove(state, isMaxPlayer)};
+        }},
+        {"external", false, false, [directory](State state, bool isMaxPlayer, int depth) -> SearchResult {
+            ExternalAnalysis analysis(directory, 1 << 20);
+            int value = analysis.analyze(state, isMaxPlayer, depth);
+            return {value, analysis.getBestState()};
+        }},
+    };
+}
+
+#endif // ENGINES_H
@@ -0,0 +1,510 @@
+#ifndef EXTERNAL_H
+#define EXTERNAL_H
+
+#include <fstream>
+#include <queue>
+#include <string>
+#include <cstdint>
+#include <cstdio>
+#include "state.h"
+#include "tree.h"
+
+using namespace std;
+
+/*
+external memory analysis for sequences too long for the in-memory tree
+
+every level of the tree is kept on disk as a sorted run of packed states,
+next level is built by sorting generated child states in memory sized chunks
+and merging the chunks with duplicates removed
+values are then propagated backwards one level at a time, by joining
+(child, parent index) pairs with the sorted child level
+*/
+
+// packed state, 15 bits per number count, points parity and bank parity
+// heuristic value only depends on parities, so the values stay the same
+typedef uint64_t PackedState;
+
+const int PACKED_COUNT_BITS = 15;
+const int PACKED_COUNT_MAX = (1 << PACKED_COUNT_BITS) - 1;
+
+inline PackedState packState(State state) {
+    map<int, int> numbers = state.getNumberMap();
+    PackedState packed = 0;
+
+    for (int number = 1; number <= 4; number++) {
+        packed = (packed << PACKED_COUNT_BITS) | PackedState(numbers[number]);
+    }
+    packed = (packed << 1) | PackedState(state.getPoints() % 2);
+    packed = (packed << 1) | PackedState(state.getBank() % 2);
+
+    return packed;
+}
+
+// check if every state reachable from state fits in a packed state
+// dividing moves weight to smaller numbers, so no count grows above the weight
+inline bool isPackable(State state) {
+    map<int, int> numbers = state.getNumberMap();
+    int weight = numbers[1] + numbers[3] + 2 * numbers[2] + 4 * numbers[4];
+    return weight <= PACKED_COUNT_MAX;
+}
+
+inline State unpackState(PackedState packed) {
+    int bank = packed & 1;
+    int points = (packed >> 1) & 1;
+    map<int, int> numbers;
+
+    packed >>= 2;
+    for (int number = 4; number >= 1; number--) {
+        numbers[number] = packed & PACKED_COUNT_MAX;
+        packed >>= PACKED_COUNT_BITS;
+    }
+
+    return State(numbers, points, bank);
+}
+
+// number count in packed state
+inline int packedCount(PackedState state, int number) {
+    return (state >> (2 + PACKED_COUNT_BITS * (4 - number))) & PACKED_COUNT_MAX;
+}
+
+// adds to number count in packed state
+inline PackedState addPackedCount(PackedState state, int number, int amount) {
+    return state + (PackedState(int64_t(amount)) << (2 + PACKED_COUNT_BITS * (4 - number)));
+}
+
+// check if packed state is an end state
+inline bool isPackedFinished(PackedState state) {
+    return (state >> 2) == 0;
+}
+
+// writes child states of packed state, same moves and order as Tree::generateChildStates
+// returns child count, at most 6
+inline int packedChildStates(PackedState state, PackedState* children) {
+    int count = 0;
+
+    for (int number = 1; number <= 4; number++) {
+        if (packedCount(state, number) == 0) continue;
+
+        // remove number, odd numbers change points parity
+        children[count++] = addPackedCount(state, number, -1) ^ PackedState((number % 2) << 1);
+
+        // divide 2 into two 1, bank changes by one
+        if (number == 2)
+            children[count++] = addPackedCount(addPackedCount(state, 2, -1), 1, 2) ^ 1;
+        // divide 4 into two 2, points change by two
+        if (number == 4)
+            children[count++] = addPackedCount(addPackedCount(state, 4, -1), 2, 2);
+    }
+
+    return count;
+}
+
+// run record, sorted by key and then by data
+struct Record {
+    uint64_t key;
+    uint64_t data;
+
+    bool operator<(const Record& record) const {
+        if (key != record.key) {
+            return key < record.key;
+        }
+        return data < record.data;
+    }
+
+    bool operator==(const Record& record) const {
+        return key == record.key && data == record.data;
+    }
+};
+
+// writes sorted records, keys are delta encoded and stored as varints
+class RunWriter {
+private:
+    ofstream file;
+    uint64_t lastKey = 0;
+
+    void writeVarint(uint64_t value) {
+        while (value >= 0x80) {
+            file.put(char((value & 0x7f) | 0x80));
+            value >>= 7;
+        }
+        file.put(char(value));
+    }
+
+public:
+    RunWriter(string path) : file(path, ios::binary | ios::trunc) {}
+
+    void write(Record record) {
+        writeVarint(record.key - lastKey);
+        writeVarint(record.data);
+        lastKey = record.key;
+    }
+
+    // closes file, returns false if it couldn't be opened or written
+    bool close() {
+        file.close();
+        return !file.fail();
+    }
+};
+
+// reads records written by RunWriter
+class RunReader {
+private:
+    ifstream file;
+    uint64_t lastKey = 0;
+    bool isFailed;  // file couldn't be opened or ends inside a record
+
+    bool readVarint(uint64_t& value) {
+        int shift = 0;
+        int byte;
+
+        value = 0;
+        while ((byte = file.get()) != EOF) {
+            value |= uint64_t(byte & 0x7f) << shift;
+            if (!(byte & 0x80))
+                return true;
+            shift += 7;
+        }
+
+        if (shift > 0) isFailed = true;
+        return false;
+    }
+
+public:
+    RunReader(string path) : file(path, ios::binary), isFailed(!file.is_open()) {}
+
+    // returns false at end of file or on a read error, see hasFailed
+    bool read(Record& record) {
+        uint64_t delta;
+        if (!readVarint(delta))
+            return false;
+        if (!readVarint(record.data)) {
+            isFailed = true;
+            return false;
+        }
+
+        lastKey += delta;
+        record.key = lastKey;
+        return true;
+    }
+
+    bool hasFailed() const { return isFailed || file.bad(); }
+};
+
+// sorts records that don't fit in memory, equal records are written once
+class ExternalSorter {
+private:
+    string path;            // output file, runs are stored next to it
+    size_t bufferSize;      // records sorted in memory at once
+    vector<Record> buffer;  // records of the current run
+    vector<string> runs;    // written run files
+    size_t runCount = 0;    // run files created so far
+    bool isFailed = false;  // a run couldn't be written or read
+
+    static constexpr size_t MERGE_WAYS = 64;  // runs merged at once
+
+    // sorts buffer and writes it as a new run
+    void writeRun() {
+        string runPath = path + "." + to_string(runCount++);
+        RunWriter writer(runPath);
+
+        sort(buffer.begin(), buffer.end());
+        for (size_t i = 0; i < buffer.size(); i++) {
+            if (i == 0 || !(buffer[i] == buffer[i - 1]))
+                writer.write(buffer[i]);
+        }
+
+        buffer.clear();
+        runs.push_back(runPath);
+        if (!writer.close()) isFailed = true;
+    }
+
+    // merges runs into output file, removing equal records
+    void mergeRuns(const vector<string>& inputs, string output) {
+        typedef pair<Record, size_t> Entry;  // record and its run
+        vector<RunReader*> readers;
+        priority_queue<Entry, vector<Entry>, greater<Entry>> heap;
+        RunWriter writer(output);
+        Record record;
+        Record lastRecord = {0, 0};
+        bool hasLast = false;
+
+        for (size_t i = 0; i < inputs.size(); i++) {
+            readers.push_back(new RunReader(inputs[i]));
+            if (readers[i]->read(record))
+                heap.push({record, i});
+        }
+
+        while (!heap.empty()) {
+            Entry entry = heap.top();
+            heap.pop();
+
+            if (!hasLast || !(entry.first == lastRecord)) {
+                writer.write(entry.first);
+                lastRecord = entry.first;
+                hasLast = true;
+            }
+
+            if (readers[entry.second]->read(record))
+                heap.push({record, entry.second});
+        }
+
+        for (size_t i = 0; i < inputs.size(); i++) {
+            if (readers[i]->hasFailed()) isFailed = true;
+            delete readers[i];
+            remove(inputs[i].c_str());
+        }
+        if (!writer.close()) isFailed = true;
+    }
+
+public:
+    ExternalSorter(string path, size_t bufferSize) : path(path), bufferSize(max(bufferSize, size_t(1))) {}
+
+    void add(Record record) {
+        buffer.push_back(record);
+        if (buffer.size() >= bufferSize)
+            writeRun();
+    }
+
+    // merges all runs into the output file, returns false if a file couldn't be
+    // written or read
+    bool finish() {
+        writeRun();
+
+        // merge in several passes if there are too many runs
+        while (runs.size() > MERGE_WAYS) {
+            vector<string> nextRuns;
+            for (size_t i = 0; i < runs.size(); i += MERGE_WAYS) {
+                vector<string> group(runs.begin() + i, runs.begin() + min(i + MERGE_WAYS, runs.size()));
+                string runPath = path + "." + to_string(runCount++);
+                mergeRuns(group, runPath);
+                nextRuns.push_back(runPath);
+            }
+            runs = nextRuns;
+        }
+
+        mergeRuns(runs, path);
+        runs.clear();
+        return !isFailed;
+    }
+};
+
+// minimax over levels stored on disk
+class ExternalAnalysis {
+private:
+    string directory;            // directory for level files
+    size_t bufferSize;           // records held in memory while sorting
+    vector<size_t> levelSizes;   // unique states in each level
+    State bestState;             // state after the best root move
+    string error;                // first file error, empty if none
+
+    void fail(const string& message) {
+        if (error.empty()) error = message;
+    }
+
+    string levelPath(int level) { return directory + "/level" + to_string(level); }
+    string valuePath(int level) { return directory + "/value" + to_string(level); }
+
+    // builds next level from the given level, returns its size
+    size_t generateLevel(int level) {
+        RunReader reader(levelPath(level));
+        ExternalSorter sorter(levelPath(level + 1), bufferSize);
+        Record record;
+
+        while (reader.read(record)) {
+            State state = unpackState(record.key);
+            for (State childState : Tree::generateChildStates(state)) {
+                sorter.add({packState(childState), 0});
+            }
+        }
+        if (reader.hasFailed()) fail("can't read " + levelPath(level));
+        if (!sorter.finish()) fail("can't write " + levelPath(level + 1));
+
+        // count unique states in next level
+        RunReader nextReader(levelPath(level + 1));
+        size_t size = 0;
+        while (nextReader.read(record)) size++;
+        if (nextReader.hasFailed()) fail("can't read " + levelPath(level + 1));
+
+        return size;
+    }
+
+    // computes values of given level from values of the next level
+    void evaluateLevel(int level, bool isMaxPlayer, bool isLastLevel) {
+        string pairPath = directory + "/pairs" + to_string(level);
+        string joinPath = directory + "/join" + to_string(level);
+        Record record;
+
+        if (!isLastLevel) {
+            // (child state, parent index) pairs sorted by child state
+            ExternalSorter pairSorter(pairPath, bufferSize);
+            RunReader reader(levelPath(level));
+            for (uint64_t index = 0; reader.read(record); index++) {
+                State state = unpackState(record.key);
+                if (state.hasFinished()) continue;
+
+                for (State childState : Tree::generateChildStates(state)) {
+                    pairSorter.add({packState(childState), index});
+                }
+            }
+            if (reader.hasFailed()) fail("can't read " + levelPath(level));
+            if (!pairSorter.finish()) fail("can't write " + pairPath);
+
+            // join with next level values, result sorted by parent index
+            ExternalSorter joinSorter(joinPath, bufferSize);
+            RunReader pairReader(pairPath);
+            RunReader valueReader(valuePath(level + 1));
+            Record value = {0, 0};
+            bool hasValue = valueReader.read(value);
+            while (pairReader.read(record)) {
+                while (hasValue && value.key < record.key)
+                    hasValue = valueReader.read(value);
+                joinSorter.add({record.data, value.data});
+            }
+            if (pairReader.hasFailed()) fail("can't read " + pairPath);
+            if (valueReader.hasFailed()) fail("can't read " + valuePath(level + 1));
+            if (!joinSorter.finish()) fail("can't write " + joinPath);
+            remove(pairPath.c_str());
+        }
+
+        // aggregate child values of every state
+        RunReader reader(levelPath(level));
+        RunReader joinReader(joinPath);  // empty on the last level
+        RunWriter writer(valuePath(level));
+        Record join = {0, 0};
+        bool hasJoin = joinReader.read(join);
+
+        for (uint64_t index = 0; reader.read(record); index++) {
+            State state = unpackState(record.key);
+            int value;
+
+            // leaf node or set depth has been reached
+            if (state.hasFinished() || isLastLevel) {
+                value = state.heuristicValue();
+            } else {
+                value = isMaxPlayer ? MIN_VALUE : MAX_VALUE;
+                while (hasJoin && join.key == index) {
+                    int childValue = int(join.data) + MIN_VALUE;
+                    value = isMaxPlayer ? max(value, childValue) : min(value, childValue);
+                    hasJoin = joinReader.read(join);
+                }
+            }
+
+            writer.write({record.key, uint64_t(value - MIN_VALUE)});
+        }
+
+        if (reader.hasFailed()) fail("can't read " + levelPath(level));
+        if (!isLastLevel && joinReader.hasFailed()) fail("can't read " + joinPath);
+        if (!writer.close()) fail("can't write " + valuePath(level));
+        remove(joinPath.c_str());
+    }
+
+public:
+    static constexpr int MIN_VALUE = -10;  // lowest heuristic value
+    static constexpr int MAX_VALUE = 10;   // highest heuristic value
+    static constexpr int TOO_LONG = MIN_VALUE - 1;  // state can't be packed
+    static constexpr int FILE_ERROR = MIN_VALUE - 2;  // level file couldn't be written or read, see getError
+
+    ExternalAnalysis(string directory, size_t memoryBudget)
+        : directory(directory), bufferSize(memoryBudget / sizeof(Record)) {}
+
+    // analyses state to given depth, -1 for full depth, returns root value
+    // returns TOO_LONG if state can't be packed, FILE_ERROR if the directory can't be used
+    int analyze(State state, bool isMaxPlayer, int depth = -1) {
+        if (!isPackable(state))
+            return TOO_LONG;
+
+        levelSizes.clear();
+        bestState = state;
+        error.clear();
+
+        // root level
+        {
+            RunWriter writer(levelPath(0));
+            writer.write({packState(state), 0});
+            if (!writer.close()) {
+                remove(levelPath(0).c_str());
+                fail("can't write " + levelPath(0));
+                return FILE_ERROR;
+            }
+        }
+        levelSizes.push_back(1);
+
+        // forward pass, build levels until depth is reached or no states are left
+        int lastLevel = 0;
+        while (depth == -1 || lastLevel < depth) {
+            size_t size = generateLevel(lastLevel);
+            if (!error.empty()) {
+                for (int level = 0; level <= lastLevel + 1; level++) {
+                    remove(levelPath(level).c_str());
+                }
+                return FILE_ERROR;
+            }
+            if (size == 0) {
+                remove(levelPath(lastLevel + 1).c_str());
+                break;
+            }
+
+            levelSizes.push_back(size);
+            lastLevel++;
+        }
+
+        // backward pass, level values from the last level to the root
+        map<PackedState, int> rootChildValues;
+        for (int level = lastLevel; level >= 0; level--) {
+            bool isLevelMax = (level % 2 == 0) ? isMaxPlayer : !isMaxPlayer;
+            evaluateLevel(level, isLevelMax, level == lastLevel);
+
+            // keep root child values to find the best move
+            if (level == 1) {
+                RunReader reader(valuePath(1));
+                Record record;
+                while (reader.read(record))
+                    rootChildValues[record.key] = int(record.data) + MIN_VALUE;
+                if (reader.hasFailed()) fail("can't read " + valuePath(1));
+            }
+
+            if (level < lastLevel) {
+                remove(levelPath(level + 1).c_str());
+                remove(valuePath(level + 1).c_str());
+            }
+
+            if (!error.empty()) {
+                for (int removed = 0; removed <= level; removed++) {
+                    remove(levelPath(removed).c_str());
+                    remove(valuePath(removed).c_str());
+                }
+                return FILE_ERROR;
+            }
+        }
+
+        Record record = {0, 0};
+        {
+            RunReader reader(valuePath(0));
+            if (!reader.read(record)) fail("can't read " + valuePath(0));
+        }
+        remove(levelPath(0).c_str());
+        remove(valuePath(0).c_str());
+        if (!error.empty())
+            return FILE_ERROR;
+
+        int rootValue = int(record.data) + MIN_VALUE;
+
+        // first child with the root value, as in computerMove
+        for (State childState : Tree::generateChildStates(state)) {
+            auto result = rootChildValues.find(packState(childState));
+            if (result != rootChildValues.end() && result->second == rootValue) {
+                bestState = childState;
+                break;
+            }
+        }
+
+        return rootValue;
+    }
+
+    State getBestState() const { return bestState; }
+    string getError() const { return error; }
+    vector<size_t> getLevelSizes() const { return levelSizes; }
+};
+
+#endif // EXTERNAL_H
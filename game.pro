@@ -4,19 +4,34 @@ greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
 
 CONFIG += c++17
 
+# solution table in table.h is generated at compile time
+msvc: QMAKE_CXXFLAGS += /constexpr:steps10000000
+
 # You can make your code fail to compile if it uses deprecated APIs.
 # In order to do so, uncomment the following line.
 #DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0x060000    # disables all the APIs deprecated before Qt 6.0.0
 
 SOURCES += \
     main.cpp \
-    mainwindow.cpp
+    mainwindow.cpp \
+    numberrow.cpp
 
 HEADERS += \
     alfabeta.h \
+    analysis.h \
+    dfpn.h \
+    engine.h \
+    external.h \
+    gamelog.h \
+    leafbatch.h \
     mainwindow.h \
+    mcts.h \
     minimax.h \
+    numberrow.h \
+    solver.h \
     state.h \
+    table.h \
+    trace.h \
     tree.h
 
 FORMS += \
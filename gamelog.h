@@ -0,0 +1,164 @@
+#ifndef GAMELOG_H
+#define GAMELOG_H
+
+#include <cmath>
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <vector>
+#include "engine.h"
+
+using namespace std;
+
+/*
+compact binary log of one game, several games can be appended to one file
+
+record layout, integers are unsigned LEB128 varints unless noted
+  "NG" 1                      magic and version, 3 bytes
+  seed                        seed of random numbers
+  algorithm, depth + 1, memory budget in bytes, mcts time in microseconds, mcts threads
+  computer first              0 or 1
+  length, numbers             initial sequence, 4 numbers per byte, 2 bits each
+  moves                       one byte per move: 0x10 | number - 1, divide << 2, computer << 3
+                              computer's moves are followed by search time in microseconds
+                              and node count
+moves have no count, so they can be appended while the game is played and a game that
+was left unfinished is still a whole record, its moves end before the next magic
+a game of 20 numbers takes about 100 bytes
+*/
+
+struct LoggedMove {
+    int number;
+    bool divide;
+    bool isComputer;
+    double time;    // search time in seconds, 0 for user's moves
+    int nodeCount;  // searched nodes, 0 for user's moves
+};
+
+struct GameLog {
+    uint32_t seed = 0;
+    vector<int> numbers;          // initial sequence
+    bool isComputerFirst = false;
+    SearchSettings settings;
+    vector<LoggedMove> moves;
+};
+
+inline void writeVarint(ostream& out, uint64_t value) {
+    while (value >= 0x80) {
+        out.put(char((value & 0x7f) | 0x80));
+        value >>= 7;
+    }
+    out.put(char(value));
+}
+
+// returns false at end of file or on a too long varint
+inline bool readVarint(istream& in, uint64_t& value) {
+    value = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        int byte = in.get();
+        if (byte == EOF) return false;
+
+        value |= uint64_t(byte & 0x7f) << shift;
+        if (!(byte & 0x80)) return true;
+    }
+    return false;
+}
+
+// writes record up to moves, moves are appended with writeLoggedMove
+inline void writeGameLogHeader(ostream& out, const GameLog& log) {
+    out.write("NG\1", 3);
+    writeVarint(out, log.seed);
+
+    writeVarint(out, log.settings.algorithmType);
+    writeVarint(out, log.settings.depth + 1);
+    writeVarint(out, log.settings.memoryBudget);
+    writeVarint(out, llround(log.settings.mctsTime * 1000));
+    writeVarint(out, log.settings.mctsThreads);
+    out.put(log.isComputerFirst ? 1 : 0);
+
+    writeVarint(out, log.numbers.size());
+    for (size_t i = 0; i < log.numbers.size(); i += 4) {
+        int byte = 0;
+        for (size_t j = i; j < i + 4 && j < log.numbers.size(); j++) {
+            byte |= (log.numbers[j] - 1) << (2 * (j - i));
+        }
+        out.put(char(byte));
+    }
+
+}
+
+inline void writeLoggedMove(ostream& out, const LoggedMove& move) {
+    out.put(char(0x10 | (move.number - 1) | move.divide << 2 | move.isComputer << 3));
+    if (move.isComputer) {
+        writeVarint(out, llround(move.time * 1e6));
+        writeVarint(out, move.nodeCount);
+    }
+}
+
+inline void writeGameLog(ostream& out, const GameLog& log) {
+    writeGameLogHeader(out, log);
+    for (const LoggedMove& move : log.moves) {
+        writeLoggedMove(out, move);
+    }
+}
+
+// reads one move byte and times of computer's move, returns false on a damaged move
+inline bool readLoggedMove(istream& in, LoggedMove& move) {
+    int byte = in.get();
+    if (byte == EOF) return false;
+
+    move = {(byte & 3) + 1, (byte & 4) != 0, (byte & 8) != 0, 0, 0};
+    if (move.isComputer) {
+        uint64_t time, nodeCount;
+        if (!readVarint(in, time) || !readVarint(in, nodeCount)) return false;
+        move.time = time / 1e6;
+        move.nodeCount = int(nodeCount);
+    }
+    return true;
+}
+
+// reads next game, returns false at end of file or on a damaged record
+inline bool readGameLog(istream& in, GameLog& log) {
+    char magic[3];
+    if (!in.read(magic, 3) || magic[0] != 'N' || magic[1] != 'G' || magic[2] != 1)
+        return false;
+
+    uint64_t seed, algorithmType, depth, memoryBudget, mctsTime, mctsThreads;
+    if (!readVarint(in, seed) || !readVarint(in, algorithmType) || !readVarint(in, depth) ||
+        !readVarint(in, memoryBudget) || !readVarint(in, mctsTime) || !readVarint(in, mctsThreads))
+        return false;
+
+    log.seed = uint32_t(seed);
+    log.settings.algorithmType = int(algorithmType);
+    log.settings.depth = int(depth) - 1;
+    log.settings.memoryBudget = size_t(memoryBudget);
+    log.settings.mctsTime = mctsTime / 1000.0;
+    log.settings.mctsThreads = int(mctsThreads);
+
+    int computerFirst = in.get();
+    if (computerFirst == EOF) return false;
+    log.isComputerFirst = computerFirst != 0;
+
+    uint64_t length;
+    if (!readVarint(in, length)) return false;
+    log.numbers.clear();
+    for (uint64_t i = 0; i < length; i += 4) {
+        int byte = in.get();
+        if (byte == EOF) return false;
+        for (uint64_t j = i; j < i + 4 && j < length; j++) {
+            log.numbers.push_back(((byte >> (2 * (j - i))) & 3) + 1);
+        }
+    }
+
+    // moves end at end of file or at next record's magic
+    log.moves.clear();
+    LoggedMove move;
+    while ((in.peek() & 0xf0) == 0x10) {
+        if (!readLoggedMove(in, move)) return false;
+        log.moves.push_back(move);
+    }
+
+    return true;
+}
+
+#endif // GAMELOG_H
@@ -0,0 +1,139 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <iomanip>
+#include <random>
+#include "service.h"
+
+using namespace std;
+
+/*
+load generator for the engine service
+
+usage: load [--sessions N] [--threads T] [--length L] [--algorithm A] [--depth D] [--seed S]
+opens N games at once, in every game the user makes random moves and asks the service
+for the computer's reply, until all games are finished
+reports moves per second and latency of move requests, from request to reply
+*/
+
+double elapsed(chrono::steady_clock::time_point start) {
+    return chrono::duration<double>(chrono::steady_clock::now() - start).count();
+}
+
+// latency at given fraction of sorted latencies
+double percentile(const vector<double>& latencies, double fraction) {
+    if (latencies.empty()) return 0;
+    size_t index = min(latencies.size() - 1, size_t(fraction * latencies.size()));
+    return latencies[index];
+}
+
+int main(int argc, char *argv[]) {
+    int sessionCount = 2000, threadCount = 0, length = 20;
+    unsigned seed = 1;
+    SearchSettings settings;
+
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (strcmp(argv[i], "--sessions") == 0) sessionCount = atoi(argv[i + 1]);
+        else if (strcmp(argv[i], "--threads") == 0) threadCount = atoi(argv[i + 1]);
+        else if (strcmp(argv[i], "--length") == 0) length = atoi(argv[i + 1]);
+        else if (strcmp(argv[i], "--algorithm") == 0) settings.algorithmType = atoi(argv[i + 1]);
+        else if (strcmp(argv[i], "--depth") == 0) settings.depth = atoi(argv[i + 1]);
+        else if (strcmp(argv[i], "--seed") == 0) seed = atoi(argv[i + 1]);
+    }
+    settings.mctsTime = 10;  // short monte carlo searches, so games finish quickly
+
+    EngineService service(threadCount);
+
+    // per game data, callbacks of one game never run at the same time
+    vector<minstd_rand> randoms;
+    vector<chrono::steady_clock::time_point> requestTimes(sessionCount);
+    vector<vector<double>> latencies(sessionCount);
+
+    mutex finishedMutex;
+    condition_variable gameFinished;
+    int finishedCount = 0;
+
+    auto finishGame = [&](int sessionId) {
+        service.closeSession(sessionId);
+        lock_guard<mutex> lock(finishedMutex);
+        finishedCount++;
+        gameFinished.notify_one();
+    };
+
+    // random user's move, returns false if game is finished
+    auto userMove = [&](int sessionId) {
+        State state = service.getState(sessionId);
+        if (state.hasFinished()) return false;
+
+        vector<int> numbers = state.getUniqueNumbers();
+        int number = numbers[randoms[sessionId]() % numbers.size()];
+        bool divide = (number == 2 || number == 4) && randoms[sessionId]() % 2 == 0;
+        service.makeMove(sessionId, number, divide);
+
+        return !service.getState(sessionId).hasFinished();
+    };
+
+    EngineService::MoveCallback reply;
+    reply = [&](int sessionId, const MoveResult&) {
+        latencies[sessionId].push_back(elapsed(requestTimes[sessionId]));
+
+        if (!userMove(sessionId)) {
+            finishGame(sessionId);
+            return;
+        }
+
+        requestTimes[sessionId] = chrono::steady_clock::now();
+        service.requestMove(sessionId, reply);
+    };
+
+    srand(seed);
+    for (int i = 0; i < sessionCount; i++) {
+        vector<int> numbers;
+        for (int j = 0; j < length; j++) {
+            numbers.push_back(rand() % 4 + 1);
+        }
+        randoms.emplace_back(seed + i);
+        service.openSession(State(numbers), i % 2 == 0, settings);
+    }
+
+    auto start = chrono::steady_clock::now();
+
+    // computer starts every other game
+    for (int i = 0; i < sessionCount; i++) {
+        if (i % 2 == 1 && !userMove(i)) {
+            finishGame(i);
+            continue;
+        }
+
+        requestTimes[i] = chrono::steady_clock::now();
+        service.requestMove(i, reply);
+    }
+
+    {
+        unique_lock<mutex> lock(finishedMutex);
+        gameFinished.wait(lock, [&] { return finishedCount == sessionCount; });
+    }
+    double time = elapsed(start);
+
+    vector<double> allLatencies;
+    for (const vector<double>& sessionLatencies : latencies) {
+        allLatencies.insert(allLatencies.end(), sessionLatencies.begin(), sessionLatencies.end());
+    }
+    sort(allLatencies.begin(), allLatencies.end());
+
+    cout << sessionCount << " games, " << service.getThreadCount() << " threads, algorithm "
+         << settings.algorithmType << ", depth " << settings.depth << endl;
+    cout << allLatencies.size() << " moves in " << fixed << setprecision(2) << time << " s, "
+         << setprecision(0) << allLatencies.size() / time << " moves/s, "
+         << service.getCacheHitCount() << " from result cache" << endl;
+    cout << "latency ms" << setprecision(3)
+         << "  p50 " << percentile(allLatencies, 0.5) * 1000
+         << "  p90 " << percentile(allLatencies, 0.9) * 1000
+         << "  p99 " << percentile(allLatencies, 0.99) * 1000
+         << "  p99.9 " << percentile(allLatencies, 0.999) * 1000
+         << "  max " << (allLatencies.empty() ? 0 : allLatencies.back() * 1000) << endl;
+
+    return 0;
+}
@@ -1,11 +1,99 @@
 #include "mainwindow.h"
+#include "solver.h"
+#include "external.h"
+#include "dfpn.h"
 
 #include <QApplication>
+#include <cstring>
+#include <fstream>
 
 int main(int argc, char *argv[])
 {
+    // headless solver verification, usage: game --verify <length>
+    if (argc == 3 && strcmp(argv[1], "--verify") == 0) {
+        return verifySolver(atoi(argv[2]), cout) == 0 ? 0 : 1;
+    }
+
+    // headless external memory analysis of a random sequence
+    // usage: game --external <length> <depth> [directory] [memory MB]
+    if ((argc >= 4 && argc <= 6) && strcmp(argv[1], "--external") == 0) {
+        string directory = argc >= 5 ? argv[4] : ".";
+        size_t memoryBudget = size_t(argc >= 6 ? atoi(argv[5]) : 256) * 1024 * 1024;
+
+        State state(atoi(argv[2]));
+        ExternalAnalysis analysis(directory, memoryBudget);
+        int value = analysis.analyze(state, true, atoi(argv[3]));
+        if (value == ExternalAnalysis::TOO_LONG) {
+            cout << "sequence too long" << endl;
+            return 1;
+        }
+        if (value == ExternalAnalysis::FILE_ERROR) {
+            cout << analysis.getError() << endl;
+            return 1;
+        }
+
+        vector<size_t> levelSizes = analysis.getLevelSizes();
+        for (size_t level = 0; level < levelSizes.size(); level++) {
+            cout << "level " << level << ": " << levelSizes[level] << " states" << endl;
+        }
+        cout << "value " << value << endl;
+        return 0;
+    }
+
+    // headless proof-number search of a random sequence
+    // usage: game --prove <length> [memory MB]
+    if ((argc == 3 || argc == 4) && strcmp(argv[1], "--prove") == 0) {
+        size_t memoryBudget = size_t(argc == 4 ? atoi(argv[3]) : 64) * 1024 * 1024;
+
+        State state(atoi(argv[2]));
+        ProofNumberSearch search(memoryBudget);
+        clock_t startTime = clock();
+        int winner = search.solve(state, true);
+        State bestState = search.solveMove(state, true);
+        double time = double(clock() - startTime) / CLOCKS_PER_SEC;
+
+        const char* results[] = {"unknown, node limit reached", "player 1 wins", "player 2 wins", "draw"};
+        cout << results[winner] << endl;
+
+        // move that leads to the best state
+        for (int number : state.getUniqueNumbers()) {
+            for (bool divide : {false, true}) {
+                if (divide && number != 2 && number != 4) continue;
+
+                State childState = state;
+                childState.doAction(number, divide);
+                if (childState == bestState)
+                    cout << "move " << (divide ? "divide " : "remove ") << number << endl;
+            }
+        }
+        cout << search.getNodeCount() << " nodes, " << search.getTableSize() << " table entries, "
+             << time << " s" << endl;
+        return 0;
+    }
+
+    // timeline of search phases and repaints, written on exit
+    // binary log of finished games, which replay re-executes
+    // usage: game [--trace <file>] [--log <file>]
+    string tracePath, logPath;
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (strcmp(argv[i], "--trace") == 0) tracePath = argv[i + 1];
+        else if (strcmp(argv[i], "--log") == 0) logPath = argv[i + 1];
+    }
+    if (!tracePath.empty()) {
+        Trace::start();
+    }
+
     QApplication a(argc, argv);
     MainWindow w;
+    w.setLogPath(logPath);
     w.show();
-    return a.exec();
+    int result = a.exec();
+
+    if (!tracePath.empty()) {
+        Trace::stop();
+        ofstream traceFile(tracePath);
+        Trace::write(traceFile);
+    }
+
+    return result;
 }
@@ -2,13 +2,8 @@
 #include "ui_mainwindow.h"
 
 #include <QKeyEvent>
-#include <QThread>
-#include "minimax.h"
-#include "alfabeta.h"
-
-const int MAX = numeric_limits<int>::max();  // highest possible value
-const int MIN = numeric_limits<int>::min();  // lowest possible value
-int nodeCount;  // node count used in minimax and alfa beta
+#include <QTimer>
+#include <fstream>
 
 MainWindow::MainWindow(QWidget *parent)
     : QMainWindow(parent)
@@ -32,11 +27,18 @@ MainWindow::MainWindow(QWidget *parent)
 
 MainWindow::~MainWindow()
 {
+    stopPondering();
     delete ui;
 }
 
+void MainWindow::setLogPath(const string& path) {
+    logPath = path;
+}
+
 // sets initial settings
 void MainWindow::initializeSettings() {
+    stopPondering();
+
     // set default number row length
     setLength(15);
 
@@ -57,7 +59,8 @@ void MainWindow::startGame() {
     shownState.points = 0;
 
     // generates new random numbers in rangge [1;4]
-    srand(time(0));
+    unsigned seed = time(0);
+    srand(seed);
     for (int i = 0; i < length; i++) {
         shownState.numbers.push_back(rand() % 4 + 1);
     }
@@ -65,7 +68,6 @@ void MainWindow::startGame() {
     // creates a new inner state
     state = State(shownState.numbers);
 
-    nodeCount = 0;
     totalNodeCount = 0;
     curIndex = 0;
 
@@ -85,13 +87,26 @@ void MainWindow::startGame() {
     // which algorithm to use
     // 1 = minimax
     // 2 = alfa-beta
+    // 3 = exact solver
+    // 4 = monte carlo tree search
+    // 5 = proof-number search
     if (ui->radioMinimax->isChecked()) {
-        algorithmType = 1;
+        searchSettings.algorithmType = 1;
+    } else if (ui->radioAlfaBeta->isChecked()) {
+        searchSettings.algorithmType = 2;
+    } else if (ui->radioSolver->isChecked()) {
+        searchSettings.algorithmType = 3;
+    } else if (ui->radioMcts->isChecked()) {
+        searchSettings.algorithmType = 4;
     } else {
-        algorithmType = 2;
+        searchSettings.algorithmType = 5;
     }
 
     depth = ui->spnDepth->value();
+    searchSettings.depth = depth;
+    searchSettings.memoryBudget = size_t(ui->spnMemory->value()) * 1024 * 1024;
+    // monte carlo tree search uses all cores
+    searchSettings.mctsThreads = max(1u, std::thread::hardware_concurrency());
 
     // set screen objects
     ui->stackedWidget->setCurrentWidget(ui->pageMain);
@@ -107,21 +122,47 @@ void MainWindow::startGame() {
     ui->lblTime->setVisible(true);
     ui->lblNode->setVisible(true);
     ui->lblNodeCount->setVisible(true);
+    ui->lblHintTitle->setVisible(true);
+    ui->lblHint->setVisible(true);
+    ui->lblDepthTitle->setVisible(true);
+    ui->lblDepth->setVisible(true);
+    ui->lblMemoryTitle->setVisible(true);
+    ui->lblMemory->setVisible(true);
     ui->lblNodeEnd->setVisible(false);
     ui->lblNodeCountEnd->setVisible(false);
 
     ui->lblTime->setText("");
     ui->lblNodeCount->setText("");
+    ui->lblDepth->setText("");
+    ui->lblMemory->setText("");
+    ui->lblHint->setText("");
+    hintSearch.clear();
+    hintMoves.clear();
+
+    gameLog = GameLog();
+    gameLog.seed = seed;
+    gameLog.numbers = shownState.numbers;
+    gameLog.isComputerFirst = firstPlayer == 2;
+    gameLog.settings = searchSettings;
+    if (!logPath.empty()) {
+        if (!logFile.is_open()) logFile.open(logPath, ios::binary | ios::app);
+        writeGameLogHeader(logFile, gameLog);
+        logFile.flush();
+    }
 
     updateState();
 
     if (firstPlayer == 2) {
         computerMove();
+    } else {
+        updateHint();
+        startPondering();
     }
 }
 
 // updates state shown on screen
 void MainWindow::updateState() {
+    TRACE_ZONE("MainWindow::updateState");
     if (curPlayer == 1) {
         ui->btnLeft->setDisabled(false);
         ui->btnRight->setDisabled(false);
@@ -134,7 +175,8 @@ void MainWindow::updateState() {
 
     if (state.hasFinished()) {
         gameOver();
-        ui->lblNumbers->setText("");
+        ui->numberRow->setNumbers({});
+        ui->numberRow->setHighlight(-1, Qt::blue);
         return;
     }
 
@@ -143,17 +185,8 @@ void MainWindow::updateState() {
     }
 
     // numbers shown on screen
-    QString numberString = "";
-    for (int i = 0; i < shownState.numbers.size(); ++i) {
-        if (curIndex == i) {
-            numberString += "<font color='blue'><b>[";
-            numberString += QString::number(shownState.numbers[i]);
-            numberString += "]</b></font>";
-        } else {
-            numberString += QString::number(shownState.numbers[i]);
-        }
-    }
-    ui->lblNumbers->setText(numberString);
+    ui->numberRow->setNumbers(shownState.numbers);
+    ui->numberRow->setHighlight(curIndex, Qt::blue);
 
     if (shownState.numbers[curIndex] == 2 || shownState.numbers[curIndex] == 4) {
         ui->btnDivide->setDisabled(false);
@@ -162,6 +195,36 @@ void MainWindow::updateState() {
     }
 }
 
+// shows values of all user's moves
+void MainWindow::updateHint() {
+    if (curPlayer != 1 || state.hasFinished()) {
+        ui->lblHint->setText("");
+        hintMoves.clear();
+        return;
+    }
+
+    bool isMaxPlayer = (firstPlayer == 1);
+    hintMoves = hintSearch.analyze(state, isMaxPlayer, depth);
+    const vector<MoveValue>& moves = hintMoves;
+
+    // best value for user
+    int bestValue = moves[0].value;
+    for (const MoveValue& move : moves) {
+        bestValue = isMaxPlayer ? max(bestValue, move.value) : min(bestValue, move.value);
+    }
+
+    QString hintString = "";
+    for (const MoveValue& move : moves) {
+        hintString += move.divide ? "sadalīt " : "paņemt ";
+        hintString += QString::number(move.number) + ": " + QString::number(move.value);
+        if (move.value == bestValue) {
+            hintString += " *";
+        }
+        hintString += "\n";
+    }
+    ui->lblHint->setText(hintString);
+}
+
 // sets end screen when game has ended
 void MainWindow::gameOver() {
     ui->btnRemove->setVisible(false);
@@ -175,6 +238,12 @@ void MainWindow::gameOver() {
     ui->lblTime->setVisible(false);
     ui->lblNode->setVisible(false);
     ui->lblNodeCount->setVisible(false);
+    ui->lblHintTitle->setVisible(false);
+    ui->lblHint->setVisible(false);
+    ui->lblDepthTitle->setVisible(false);
+    ui->lblDepth->setVisible(false);
+    ui->lblMemoryTitle->setVisible(false);
+    ui->lblMemory->setVisible(false);
     ui->lblNodeEnd->setVisible(true);
     ui->lblNodeCountEnd->setVisible(true);
 
@@ -201,6 +270,15 @@ void MainWindow::gameOver() {
     ui->lblWinner->setVisible(true);
 }
 
+// adds move to game log and writes it to log file
+void MainWindow::logMove(const LoggedMove& move) {
+    gameLog.moves.push_back(move);
+    if (logFile.is_open()) {
+        writeLoggedMove(logFile, move);
+        logFile.flush();
+    }
+}
+
 // action when number is removed
 void MainWindow::actionRemove() {
     if (state.hasFinished() || curPlayer == 2) return;
@@ -209,6 +287,7 @@ void MainWindow::actionRemove() {
     shownState.numbers.erase(shownState.numbers.begin() + curIndex);
 
     state.doAction(number, false);
+    logMove({number, false, false, 0, 0});
 
     shownState.points = state.getPoints();
 
@@ -233,6 +312,7 @@ void MainWindow::actionDivide() {
     }
 
     state.doAction(number, true);
+    logMove({number, true, false, 0, 0});
 
     shownState.points = state.getPoints();
     shownState.bank = state.getBank();
@@ -249,51 +329,32 @@ void MainWindow::computerMove() {
     ui->btnRemove->setDisabled(true);
     ui->btnDivide->setDisabled(true);
 
-    QString numberString = "";
-    for (int number : shownState.numbers) {
-        numberString += QString::number(number);
-    }
-    ui->lblNumbers->setText(numberString);
-    ui->stackedWidget->repaint();
+    ui->numberRow->setHighlight(-1, Qt::blue);
 
-    clock_t startTime, endTime;
+    clock_t startTime = clock();
 
-    startTime = clock();
-    // generate tree
-    Tree tree(state);
-    tree.generateTree(depth);
-    endTime = clock();
-
-    double treeTime = double(endTime - startTime) / CLOCKS_PER_SEC;
-
-    bool isMaxPlayer = (firstPlayer == 2);
-
-    int optimalValue;
-    nodeCount = 0;
-
-    startTime = clock();
-    // use minimax or alfa-beta
-    if (algorithmType == 1) {
-        optimalValue = minimax(tree.getRoot(), isMaxPlayer, depth);
+    // use pondered search if user's move was searched in advance or is being searched
+    finishPondering(state);
+    MoveResult result;
+    double searchTime;  // logged time of the search itself, also if it was pondered
+    auto pondered = ponderResults.find(state);
+    if (pondered != ponderResults.end()) {
+        result = pondered->second;
+        searchTime = result.time;
+        result.time = double(clock() - startTime) / CLOCKS_PER_SEC;
     } else {
-        optimalValue = alfabeta(tree.getRoot(), isMaxPlayer, depth, MIN, MAX);
+        result = searchMove(state, firstPlayer == 2, searchSettings);
+        searchTime = result.time;
     }
-    endTime = clock();
+    ponderResults.clear();
 
-    double algorithmTime = double(endTime - startTime) / CLOCKS_PER_SEC;
-    double totalTime = treeTime + algorithmTime;
+    State bestState = result.bestState;
+    double totalTime = result.time;
+    int treeDepth = result.treeDepth;
+    size_t treeMemory = result.treeMemory;
+    int nodeCount = result.nodeCount;
 
     totalNodeCount += nodeCount;
-    State bestState;
-
-    // finds next computer state
-    for (Node* node : tree.getRoot()->getChildNodes()) {
-        // if child nodes value matches algorithms found value, state found
-        if (node->getValue() == optimalValue) {
-            bestState = node->getState();
-            break;
-        }
-    }
 
     int actionNumber = 0;       // computer picked number
     bool actionOption = false;  // computer picked option
@@ -315,6 +376,7 @@ void MainWindow::computerMove() {
         }
     }
     state = bestState;
+    logMove({actionNumber, actionOption, true, searchTime, nodeCount});
 
     // find number position on screen state
     int index = 0;
@@ -326,23 +388,24 @@ void MainWindow::computerMove() {
     }
 
     // show computer picked number
-    numberString = "";
-    for (int i = 0; i < shownState.numbers.size(); ++i) {
-        if (index == i) {
-            numberString += "<font color='red'><b>[";
-            numberString += QString::number(shownState.numbers[i]);
-            numberString += "]</b></font>";
-        } else {
-            numberString += QString::number(shownState.numbers[i]);
-        }
-    }
-    ui->lblNumbers->setText(numberString);
+    ui->numberRow->setHighlight(index, Qt::red);
     ui->lblTime->setText(QString::number(totalTime) + "s");
     ui->lblNodeCount->setText(QString::number(nodeCount));
-    ui->stackedWidget->repaint();
+    ui->lblDepth->setText(QString::number(treeDepth));
+    ui->lblMemory->setText(QString::number(treeMemory / 1024.0 / 1024.0, 'f', 2) + " MB");
+
+    // wait to display computer move, screen is painted by event loop meanwhile
+    pendingMove.number = actionNumber;
+    pendingMove.index = index;
+    pendingMove.divide = actionOption;
+    QTimer::singleShot(1000, this, SLOT (finishComputerMove()));
+}
 
-    // wait to display computer move
-    QThread::sleep(1);
+// reflects computer's move on screen after it has been shown
+void MainWindow::finishComputerMove() {
+    int actionNumber = pendingMove.number;
+    int index = pendingMove.index;
+    bool actionOption = pendingMove.divide;
 
     // reflect next state on screen state
     if (actionOption) {
@@ -364,6 +427,87 @@ void MainWindow::computerMove() {
     updateState();
 }
 
+// searches computer's replies to user's moves while user is thinking
+// a stopped search is not kept, as its move may be wrong
+void MainWindow::ponder(vector<State> userStates, SearchSettings settings) {
+    for (const State& userState : userStates) {
+        {
+            lock_guard<mutex> lock(ponderMutex);
+            if (isPonderStopped || isPonderFinishing) return;
+            ponderedState = userState;
+            isPonderSearching = true;
+        }
+
+        MoveResult result = searchMove(userState, firstPlayer == 2, settings, &isPonderStopped);
+
+        lock_guard<mutex> lock(ponderMutex);
+        isPonderSearching = false;
+        if (!result.isStopped) {
+            ponderResults[userState] = result;
+        }
+    }
+}
+
+// starts pondering from current state in background
+// user's moves are pondered from the best one by hint values, which user most likely makes
+void MainWindow::startPondering() {
+    stopPondering();
+    ponderResults.clear();
+
+    bool isUserMax = (firstPlayer == 1);
+    vector<MoveValue> moves = hintMoves;
+    stable_sort(moves.begin(), moves.end(), [isUserMax](const MoveValue& a, const MoveValue& b) {
+        return isUserMax ? a.value > b.value : a.value < b.value;
+    });
+
+    vector<State> userStates;
+    for (const MoveValue& move : moves) {
+        State userState = state;
+        userState.doAction(move.number, move.divide);
+        if (!userState.hasFinished() && find(userStates.begin(), userStates.end(), userState) == userStates.end()) {
+            userStates.push_back(userState);
+        }
+    }
+    // without hint all moves are pondered in generated order
+    if (moves.empty()) {
+        for (State userState : Tree::generateChildStates(state)) {
+            if (!userState.hasFinished()) userStates.push_back(userState);
+        }
+    }
+
+    // one core is left to the window
+    SearchSettings settings = searchSettings;
+    settings.mctsThreads = min(settings.mctsThreads, max(1, int(std::thread::hardware_concurrency()) - 1));
+
+    isPonderStopped = false;
+    isPonderFinishing = false;
+    ponderThread = std::thread(&MainWindow::ponder, this, userStates, settings);
+}
+
+// stops pondering, the running search ends at its next check of the flag
+void MainWindow::stopPondering() {
+    isPonderStopped = true;
+    if (ponderThread.joinable()) {
+        ponderThread.join();
+    }
+}
+
+// stops pondering after user's move, a running search of the state user made
+// is finished, as its result is the computer's reply, searches of other states are stopped
+void MainWindow::finishPondering(const State& userState) {
+    {
+        lock_guard<mutex> lock(ponderMutex);
+        isPonderFinishing = true;
+        if (!isPonderSearching || !(ponderedState == userState)) {
+            isPonderStopped = true;
+        }
+    }
+    if (ponderThread.joinable()) {
+        ponderThread.join();
+    }
+    isPonderStopped = true;
+}
+
 // player moves to the left number
 void MainWindow::indexLeft() {
     if (curIndex > 0) {
@@ -398,15 +542,23 @@ void MainWindow::changePlayer() {
         ui->lblCurrentPlayer->setText(QString("<font color='red'>Dators</font>"));
     }
 
-    // calls computers move if computers turn
+    // calls computers move if computers turn, otherwise prepares replies to user's moves
+    // hint is searched once per user's turn
     if (!state.hasFinished() && curPlayer == 2) {
+        ui->lblHint->setText("");
         computerMove();
+    } else if (!state.hasFinished()) {
+        updateHint();
+        startPondering();
+    } else {
+        ui->lblHint->setText("");
     }
 }
 
 // handle key presses
 void MainWindow::keyPressEvent(QKeyEvent *event) {
-    if (ui->stackedWidget->currentWidget() == ui->pageMain) {
+    // keys are ignored while computer's move is shown
+    if (ui->stackedWidget->currentWidget() == ui->pageMain && curPlayer == 1) {
         if (event->key() == Qt::Key_A) {
             indexLeft();
             return;
@@ -2,8 +2,15 @@
 #define MAINWINDOW_H
 
 #include <QMainWindow>
+#include <atomic>
+#include <fstream>
+#include <mutex>
+#include <thread>
 #include "state.h"
 #include "tree.h"
+#include "analysis.h"
+#include "engine.h"
+#include "gamelog.h"
 
 QT_BEGIN_NAMESPACE
 namespace Ui {
@@ -19,6 +26,9 @@ public:
     MainWindow(QWidget *parent = nullptr);
     ~MainWindow();
 
+    // finished games are appended to log file, empty path for no log
+    void setLogPath(const string& path);
+
 protected:
     void keyPressEvent(QKeyEvent *event) override;
 
@@ -34,14 +44,51 @@ private slots:
     void setLength(int);
     void changePlayer();
     void computerMove();
+    void finishComputerMove();
 
 private:
+    void ponder(vector<State> userStates, SearchSettings settings);
+    void startPondering();
+    void stopPondering();
+    void finishPondering(const State& userState);
+    void updateHint();
+    void logMove(const LoggedMove& move);
+
     Ui::MainWindow *ui;
 
     int points, curIndex, curPlayer, depth, totalNodeCount;
     vector<int> numbers;
     State state;
-    int firstPlayer, algorithmType, length;
+    int firstPlayer, length;
+    SearchSettings searchSettings;  // algorithm and limits of computer's moves
+
+    // moves of current game, appended to log file as they are made
+    // so that unfinished games are logged too
+    GameLog gameLog;
+    string logPath;
+    ofstream logFile;
+
+    // computer's replies searched during user's turn
+    // only read after the pondering thread has finished
+    map<State, MoveResult> ponderResults;
+    std::thread ponderThread;  // std:: as QObject has a thread() member
+    atomic<bool> isPonderStopped{true};  // running search is stopped too
+
+    // state searched by the pondering thread, guarded by ponderMutex
+    mutex ponderMutex;
+    State ponderedState;
+    bool isPonderSearching = false;
+    bool isPonderFinishing = false;  // no search is started after the running one
+
+    // values of user's moves, cache is shared between moves of a game
+    MultiPvSearch hintSearch;
+    vector<MoveValue> hintMoves;  // of current user's turn, empty if there is no hint
+
+    // computer's move, shown on screen before it is made
+    struct {
+        int number, index;
+        bool divide;
+    } pendingMove;
 
     // state that is shown on screen, which differs from inner state
     struct {
@@ -0,0 +1,216 @@
+#ifndef MCTS_H
+#define MCTS_H
+
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include "state.h"
+#include "tree.h"
+#include "external.h"
+
+using namespace std;
+
+/*
+monte carlo tree search for sequences too long for minimax over the full tree
+
+nodes are selected with UCT, unvisited leaves are expanded and finished with random
+playouts over packed states, so playouts never build State or map objects
+playouts run in parallel threads over one shared tree, a node on the path of a running
+playout counts as a lost visit (virtual loss), so other threads spread to other moves
+*/
+class MctsSearch {
+private:
+    struct MctsNode {
+        PackedState state;
+        bool isMaxPlayer;               // player to move
+        atomic<int> visits{0};
+        atomic<int> score{0};           // max player result, 2 per win and 1 per draw
+        atomic<int> virtualLoss{0};     // running playouts through this node
+        atomic<int> childCount{-1};     // -1 until expanded
+        unique_ptr<MctsNode[]> children;
+        mutex expandMutex;
+    };
+
+    static constexpr double EXPLORATION = 1.4;  // UCT exploration constant
+
+    unique_ptr<MctsNode> root;
+    atomic<size_t> nodeCount{0};
+    atomic<long long> playoutCount{0};
+    size_t maxNodes;              // nodes are not expanded above this count
+    int terminalScores[4];        // end state results by points and bank parity
+
+    // xorshift random generator, one per thread
+    static uint64_t nextRandom(uint64_t& seed) {
+        seed ^= seed << 13;
+        seed ^= seed >> 7;
+        seed ^= seed << 17;
+        return seed;
+    }
+
+    int terminalScore(PackedState state) const {
+        return terminalScores[state & 3];
+    }
+
+    void expand(MctsNode* node) {
+        lock_guard<mutex> lock(node->expandMutex);
+        if (node->childCount.load(memory_order_acquire) >= 0) return;
+
+        PackedState states[6];
+        int count = packedChildStates(node->state, states);
+        if (count == 0) {
+            node->childCount.store(0, memory_order_release);
+            return;
+        }
+
+        node->children.reset(new MctsNode[count]);
+        for (int i = 0; i < count; i++) {
+            node->children[i].state = states[i];
+            node->children[i].isMaxPlayer = !node->isMaxPlayer;
+        }
+        nodeCount += count;
+
+        node->childCount.store(count, memory_order_release);
+    }
+
+    // child with the highest UCT value for the player to move
+    // running playouts count as losses, unvisited children are taken first
+    MctsNode* select(MctsNode* node, int childCount) {
+        double parentVisits = node->visits + node->virtualLoss;
+        double logVisits = log(max(parentVisits, 1.0));
+        MctsNode* bestChild = nullptr;
+        double bestValue = -1;
+
+        for (int i = 0; i < childCount; i++) {
+            MctsNode* child = &node->children[i];
+            int visits = child->visits;
+            int pending = child->virtualLoss;
+            if (visits + pending == 0) return child;
+
+            double score = child->score / 2.0;
+            double wins = node->isMaxPlayer ? score : visits - score;
+            double value = wins / (visits + pending) + EXPLORATION * sqrt(logVisits / (visits + pending));
+
+            if (value > bestValue) {
+                bestValue = value;
+                bestChild = child;
+            }
+        }
+
+        return bestChild;
+    }
+
+    // random moves until the end, returns max player score
+    int playout(PackedState state, uint64_t& seed) {
+        PackedState children[6];
+
+        while (!isPackedFinished(state)) {
+            int count = packedChildStates(state, children);
+            if (count == 0) break;
+            state = children[nextRandom(seed) % count];
+        }
+
+        return terminalScore(state);
+    }
+
+    // one selection, expansion, playout and backpropagation
+    void iterate(uint64_t& seed, vector<MctsNode*>& path) {
+        MctsNode* node = root.get();
+        path.clear();
+        path.push_back(node);
+        node->virtualLoss++;
+
+        while (!isPackedFinished(node->state)) {
+            int childCount = node->childCount.load(memory_order_acquire);
+            if (childCount < 0) {
+                // leaf is expanded on its second visit, root always
+                if (node != root.get() && (node->visits == 0 || nodeCount >= maxNodes)) break;
+                expand(node);
+                childCount = node->childCount.load(memory_order_acquire);
+            }
+            if (childCount == 0) break;
+
+            node = select(node, childCount);
+            path.push_back(node);
+            node->virtualLoss++;
+        }
+
+        int score = playout(node->state, seed);
+        playoutCount++;
+
+        for (MctsNode* pathNode : path) {
+            pathNode->score += score;
+            pathNode->visits++;
+            pathNode->virtualLoss--;
+        }
+    }
+
+public:
+    // memory budget in bytes limits tree size, 0 for no limit
+    MctsSearch(size_t memoryBudget = 0) {
+        maxNodes = memoryBudget > 0 ? memoryBudget / getNodeSize() : SIZE_MAX;
+
+        for (int parity = 0; parity < 4; parity++) {
+            int value = State(map<int, int>(), parity >> 1, parity & 1).heuristicValue();
+            terminalScores[parity] = value > 0 ? 2 : value == 0 ? 1 : 0;
+        }
+    }
+
+    // searches for given time in milliseconds, until playout limit is reached or stopFlag is set
+    // returns state after the most visited move, state itself if it can't be packed
+    State search(State state, bool isMaxPlayer, double milliseconds, int threadCount = 1,
+                 long long maxPlayouts = 0, uint64_t seed = 1, const atomic<bool>* stopFlag = nullptr) {
+        root.reset(new MctsNode);
+        root->isMaxPlayer = isMaxPlayer;
+        nodeCount = 1;
+        playoutCount = 0;
+
+        if (state.hasFinished() || !isPackable(state)) return state;
+        root->state = packState(state);
+
+        auto deadline = chrono::steady_clock::now() + chrono::duration<double, milli>(milliseconds);
+        auto work = [&](uint64_t threadSeed) {
+            vector<MctsNode*> path;
+            while (chrono::steady_clock::now() < deadline) {
+                for (int i = 0; i < 64; i++) {
+                    iterate(threadSeed, path);
+                }
+                if (maxPlayouts > 0 && playoutCount >= maxPlayouts) break;
+                if (stopFlag && stopFlag->load(memory_order_relaxed)) break;
+            }
+        };
+
+        vector<thread> threads;
+        for (int i = 1; i < threadCount; i++) {
+            threads.emplace_back(work, seed * 0x9e3779b97f4a7c15ULL + i);
+        }
+        work(seed * 0x9e3779b97f4a7c15ULL);
+        for (thread& t : threads) {
+            t.join();
+        }
+
+        // most visited child, children are in Tree::generateChildStates order
+        int bestIndex = 0;
+        for (int i = 1; i < root->childCount; i++) {
+            if (root->children[i].visits > root->children[bestIndex].visits)
+                bestIndex = i;
+        }
+
+        return Tree::generateChildStates(state)[bestIndex];
+    }
+
+    // expected max player result of the root, from -10 to 10
+    double getValue() const {
+        int visits = root ? root->visits.load() : 0;
+        return visits > 0 ? root->score * 10.0 / visits - 10 : 0;
+    }
+
+    long long getPlayoutCount() const { return playoutCount; }
+    size_t getNodeCount() const { return nodeCount; }
+    size_t getMemorySize() const { return nodeCount * getNodeSize(); }
+    static constexpr size_t getNodeSize() { return sizeof(MctsNode); }
+};
+
+#endif // MCTS_H
@@ -3,18 +3,24 @@
 
 #include <iostream>
 #include <algorithm>
+#include <atomic>
 #include "tree.h"
 
 using namespace std;
 
-extern const int MAX;
-extern const int MIN;
-extern int nodeCount;
-
-int minimax(Node* node, bool isMaxPlayer, int depth) {
-    nodeCount++;  // visited node count
+// nodeCount is increased by visited node count
+// isLeafValueSet if leaf values were set by Tree::evaluateLeaves
+// search returns 0 without a result as soon as stopFlag is set
+inline int minimax(Node* node, bool isMaxPlayer, int depth, int& nodeCount, bool isLeafValueSet = false,
+                   const atomic<bool>* stopFlag = nullptr) {
+    if (stopFlag && stopFlag->load(memory_order_relaxed))
+        return 0;
+    nodeCount++;
 
     // if leaf node or depth 0 has been reached, return heuristic function value
+    if (isLeafValueSet && node->isLeaf())
+        return node->getValue();
+
     if (node->getState().hasFinished() || depth == 0) {
         int value = node->getState().heuristicValue();
         // set nodes heuristic value, so that best child node can be found
@@ -32,7 +38,7 @@ int minimax(Node* node, bool isMaxPlayer, int depth) {
         for (Node* child : children) {
             // act as minimizing player (isMaxPlayer = false)
             // reduce depth by 1
-            int value = minimax(child, false, depth - 1);
+            int value = minimax(child, false, depth - 1, nodeCount, isLeafValueSet, stopFlag);
             bestValue = max(bestValue, value);
         }
 
@@ -49,7 +55,7 @@ int minimax(Node* node, bool isMaxPlayer, int depth) {
         for (Node* child : children) {
             // act as maximizing player player (isMaxPlayer = true)
             // reduce depth by 1
-            int value = minimax(child, true, depth - 1);
+            int value = minimax(child, true, depth - 1, nodeCount, isLeafValueSet, stopFlag);
             bestValue = min(bestValue, value);
         }
 
@@ -0,0 +1,166 @@
+#include "numberrow.h"
+#include "trace.h"
+
+#include <QFontMetrics>
+#include <QPainter>
+#include <QPaintEvent>
+#include <QWheelEvent>
+
+NumberRow::NumberRow(QWidget *parent)
+    : QWidget(parent)
+    , highlightIndex(-1)
+    , highlightColor(Qt::blue)
+    , scrollOffset(0)
+{
+    QFont boldFont = font();
+    boldFont.setBold(true);
+    cellWidth = QFontMetrics(boldFont).horizontalAdvance("[4]");
+
+    // whole widget is painted in paintEvent
+    setAttribute(Qt::WA_OpaquePaintEvent);
+}
+
+// sets numbers, repaints only cells that changed
+void NumberRow::setNumbers(const vector<int>& numbers) {
+    // first changed cell
+    size_t first = 0;
+    while (first < numbers.size() && first < this->numbers.size() && numbers[first] == this->numbers[first]) {
+        first++;
+    }
+
+    int oldSize = this->numbers.size();
+    this->numbers = numbers;
+
+    if (first == numbers.size() && int(first) == oldSize) return;
+
+    // row length changed, cells are moved when row is or was centered
+    if (int(numbers.size()) != oldSize && (oldSize * cellWidth <= width() || int(numbers.size()) * cellWidth <= width())) {
+        setScrollOffset(scrollOffset);
+        update();
+        return;
+    }
+
+    setScrollOffset(scrollOffset);
+    updateCells(first, max(oldSize, int(numbers.size())) - 1);
+}
+
+// highlights number at index, repaints only old and new highlighted cells
+void NumberRow::setHighlight(int index, QColor color) {
+    if (index == highlightIndex && color == highlightColor) return;
+
+    updateCells(highlightIndex, highlightIndex);
+    highlightIndex = index;
+    highlightColor = color;
+    updateCells(highlightIndex, highlightIndex);
+
+    ensureVisible(highlightIndex);
+}
+
+void NumberRow::paintEvent(QPaintEvent *event) {
+    TRACE_ZONE("NumberRow::paintEvent");
+    QPainter painter(this);
+    QRect area = event->rect();
+
+    painter.fillRect(area, palette().window());
+
+    if (numbers.empty()) return;
+
+    // paint only cells inside repainted area
+    int first = max(0, (area.left() - rowX()) / cellWidth);
+    int last = min(int(numbers.size()) - 1, (area.right() - rowX()) / cellWidth);
+
+    for (int i = first; i <= last; i++) {
+        QRect cell = cellRect(i);
+        const QPixmap& pixmap = glyph(numbers[i], i == highlightIndex);
+        QSize size = pixmap.size() / pixmap.devicePixelRatio();
+
+        painter.drawPixmap(cell.x() + (cell.width() - size.width()) / 2,
+                           cell.y() + (cell.height() - size.height()) / 2, pixmap);
+    }
+}
+
+void NumberRow::resizeEvent(QResizeEvent *event) {
+    QWidget::resizeEvent(event);
+    setScrollOffset(scrollOffset);
+}
+
+void NumberRow::wheelEvent(QWheelEvent *event) {
+    QPoint delta = event->angleDelta();
+    int steps = (delta.x() != 0 ? delta.x() : delta.y()) / 120;
+
+    setScrollOffset(scrollOffset - steps * cellWidth * 3);
+    event->accept();
+}
+
+// x of the first cell, row is centered if it fits
+int NumberRow::rowX() const {
+    int rowWidth = numbers.size() * cellWidth;
+    if (rowWidth <= width()) {
+        return (width() - rowWidth) / 2;
+    }
+
+    return -scrollOffset;
+}
+
+QRect NumberRow::cellRect(int index) const {
+    return QRect(rowX() + index * cellWidth, 0, cellWidth, height());
+}
+
+// schedules repaint of cells in range
+void NumberRow::updateCells(int first, int last) {
+    if (first < 0 || last < first) return;
+
+    QRect area = cellRect(first).united(cellRect(last)).intersected(rect());
+    if (!area.isEmpty()) {
+        update(area);
+    }
+}
+
+void NumberRow::setScrollOffset(int offset) {
+    int maxOffset = max(0, int(numbers.size()) * cellWidth - width());
+    offset = max(0, min(offset, maxOffset));
+
+    if (offset != scrollOffset) {
+        scrollOffset = offset;
+        update();
+    }
+}
+
+// scrolls so that the number at index is visible
+void NumberRow::ensureVisible(int index) {
+    if (index < 0) return;
+
+    int left = index * cellWidth;
+    if (left < scrollOffset) {
+        setScrollOffset(left);
+    } else if (left + cellWidth > scrollOffset + width()) {
+        setScrollOffset(left + cellWidth - width());
+    }
+}
+
+// returns rendered number, renders it on first use
+const QPixmap& NumberRow::glyph(int number, bool isHighlighted) {
+    QColor color = isHighlighted ? highlightColor : palette().color(QPalette::WindowText);
+    quint64 key = (quint64(color.rgba()) << 8) | (quint64(number) << 1) | isHighlighted;
+
+    auto result = glyphs.find(key);
+    if (result != glyphs.end()) return *result;
+
+    QFont glyphFont = font();
+    glyphFont.setBold(isHighlighted);
+    QString text = isHighlighted ? "[" + QString::number(number) + "]" : QString::number(number);
+    QFontMetrics metrics(glyphFont);
+
+    qreal ratio = devicePixelRatioF();
+    QPixmap pixmap(QSize(metrics.horizontalAdvance(text), metrics.height()) * ratio);
+    pixmap.setDevicePixelRatio(ratio);
+    pixmap.fill(Qt::transparent);
+
+    QPainter painter(&pixmap);
+    painter.setFont(glyphFont);
+    painter.setPen(color);
+    painter.drawText(0, metrics.ascent(), text);
+    painter.end();
+
+    return *glyphs.insert(key, pixmap);
+}
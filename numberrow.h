@@ -0,0 +1,45 @@
+#ifndef NUMBERROW_H
+#define NUMBERROW_H
+
+#include <QWidget>
+#include <QColor>
+#include <QHash>
+#include <QPixmap>
+#include <vector>
+
+using namespace std;
+
+// number row widget, paints numbers from cached glyphs and scrolls horizontally
+// only changed cells are repainted
+class NumberRow : public QWidget
+{
+    Q_OBJECT
+
+public:
+    NumberRow(QWidget *parent = nullptr);
+
+    void setNumbers(const vector<int>& numbers);
+    void setHighlight(int index, QColor color);  // index -1 removes highlight
+
+protected:
+    void paintEvent(QPaintEvent *event) override;
+    void resizeEvent(QResizeEvent *event) override;
+    void wheelEvent(QWheelEvent *event) override;
+
+private:
+    int rowX() const;
+    QRect cellRect(int index) const;
+    void updateCells(int first, int last);
+    void setScrollOffset(int offset);
+    void ensureVisible(int index);
+    const QPixmap& glyph(int number, bool isHighlighted);
+
+    vector<int> numbers;       // shown numbers
+    int highlightIndex;        // highlighted number, -1 if none
+    QColor highlightColor;     // highlighted number color
+    int cellWidth;             // width of one number, fits highlighted number
+    int scrollOffset;          // horizontal scroll in pixels
+    QHash<quint64, QPixmap> glyphs;  // rendered numbers by number, highlight and color
+};
+
+#endif // NUMBERROW_H
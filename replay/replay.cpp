@@ -0,0 +1,152 @@
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include "gamelog.h"
+
+using namespace std;
+
+/*
+replays game logs written by game --log, for performance comparisons between versions
+
+usage: replay --input file [--output file] [--repeat N]
+user's moves are made as logged, every computer's move is searched again with the
+logged settings, without the delays of the game window
+the logged move is kept when the search picks another one, so the game stays the same
+games left unfinished in the game window are replayed up to their last logged move
+repeat searches every move N times and keeps the fastest time, which is less noisy
+output writes the logs again with the replayed times and node counts, as a baseline
+for the next version
+reports logged and replayed time and nodes of every game and of all games
+*/
+
+// move that leads from state to bestState, number 0 if there is none
+LoggedMove findMove(State state, const State& bestState) {
+    for (int number : state.getUniqueNumbers()) {
+        for (bool divide : {false, true}) {
+            if (divide && number != 2 && number != 4) continue;
+
+            State childState = state;
+            childState.doAction(number, divide);
+            if (childState == bestState)
+                return {number, divide, true, 0, 0};
+        }
+    }
+    return {0, false, true, 0, 0};
+}
+
+int main(int argc, char *argv[]) {
+    string inputPath, outputPath;
+    int repeatCount = 1;
+
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (strcmp(argv[i], "--input") == 0) inputPath = argv[i + 1];
+        else if (strcmp(argv[i], "--output") == 0) outputPath = argv[i + 1];
+        else if (strcmp(argv[i], "--repeat") == 0) repeatCount = max(1, atoi(argv[i + 1]));
+    }
+
+    ifstream input(inputPath, ios::binary);
+    if (!input) {
+        cerr << "can't open " << inputPath << endl;
+        return 1;
+    }
+
+    ofstream output;
+    if (!outputPath.empty()) {
+        output.open(outputPath, ios::binary);
+        if (!output) {
+            cerr << "can't open " << outputPath << endl;
+            return 1;
+        }
+    }
+
+    int gameCount = 0, errorCount = 0;
+    long long totalMoveCount = 0, totalDifferentCount = 0;
+    double totalLoggedTime = 0, totalTime = 0;
+    long long totalLoggedNodes = 0, totalNodes = 0;
+
+    cout << fixed;
+
+    GameLog log;
+    while (input.peek() != EOF) {
+        if (!readGameLog(input, log)) {
+            cout << "damaged record after game " << gameCount << endl;
+            errorCount++;
+            break;
+        }
+        gameCount++;
+
+        State state(log.numbers);
+        bool isError = false;
+        int moveCount = 0, differentCount = 0;
+        double loggedTime = 0, time = 0;
+        long long loggedNodes = 0, nodes = 0;
+
+        for (LoggedMove& move : log.moves) {
+            if (state.hasFinished() || !state.validateNumber(move.number) ||
+                (move.divide && move.number != 2 && move.number != 4)) {
+                isError = true;
+                break;
+            }
+
+            if (move.isComputer) {
+                MoveResult result;
+                double bestTime = 0;
+                for (int i = 0; i < repeatCount; i++) {
+                    result = searchMove(state, log.isComputerFirst, log.settings);
+                    bestTime = i == 0 ? result.time : min(bestTime, result.time);
+                }
+
+                LoggedMove replayedMove = findMove(state, result.bestState);
+                if (replayedMove.number != move.number || replayedMove.divide != move.divide)
+                    differentCount++;
+
+                moveCount++;
+                loggedTime += move.time;
+                loggedNodes += move.nodeCount;
+                time += bestTime;
+                nodes += result.nodeCount;
+
+                move.time = bestTime;
+                move.nodeCount = result.nodeCount;
+            }
+
+            state.doAction(move.number, move.divide);
+        }
+
+        if (isError) {
+            cout << "game " << gameCount << ": invalid move" << endl;
+            errorCount++;
+            continue;
+        }
+
+        if (output.is_open())
+            writeGameLog(output, log);
+
+        cout << "game " << gameCount << ": length " << log.numbers.size() << ", algorithm "
+             << log.settings.algorithmType << ", " << moveCount << " computer's moves, logged "
+             << setprecision(4) << loggedTime << " s " << loggedNodes << " nodes, replayed "
+             << time << " s " << nodes << " nodes";
+        if (differentCount > 0)
+            cout << ", " << differentCount << " different moves";
+        cout << endl;
+
+        totalMoveCount += moveCount;
+        totalDifferentCount += differentCount;
+        totalLoggedTime += loggedTime;
+        totalTime += time;
+        totalLoggedNodes += loggedNodes;
+        totalNodes += nodes;
+    }
+
+    cout << gameCount << " games, " << totalMoveCount << " computer's moves, "
+         << totalDifferentCount << " different moves, " << errorCount << " errors" << endl;
+    cout << "logged   " << setprecision(4) << totalLoggedTime << " s  " << totalLoggedNodes << " nodes" << endl;
+    cout << "replayed " << totalTime << " s  " << totalNodes << " nodes";
+    if (totalLoggedTime > 0)
+        cout << "  time " << setprecision(2) << totalTime / totalLoggedTime << "x";
+    cout << endl;
+
+    return errorCount == 0 ? 0 : 1;
+}
@@ -0,0 +1,30 @@
+TEMPLATE = app
+TARGET = replay
+
+QT -= core gui
+
+CONFIG += c++17 console thread
+CONFIG -= app_bundle
+
+# solution table in table.h is generated at compile time
+msvc: QMAKE_CXXFLAGS += /constexpr:steps10000000
+
+INCLUDEPATH += ..
+
+SOURCES += \
+    replay.cpp
+
+HEADERS += \
+    ../alfabeta.h \
+    ../dfpn.h \
+    ../engine.h \
+    ../external.h \
+    ../gamelog.h \
+    ../leafbatch.h \
+    ../mcts.h \
+    ../minimax.h \
+    ../solver.h \
+    ../state.h \
+    ../table.h \
+    ../trace.h \
+    ../tree.h
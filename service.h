@@ -0,0 +1,299 @@
+#ifndef SERVICE_H
+#define SERVICE_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <shared_mutex>
+#include <thread>
+#include <unordered_map>
+#include "engine.h"
+#include "external.h"
+
+using namespace std;
+
+/*
+engine service for many concurrent games, without Qt
+
+every game is a session with its own state and search settings, move requests of
+all sessions are searched by one shared thread pool
+sessions take turns in a round robin queue, one request per turn, so sessions with
+many queued requests or slow settings can't starve the others
+exact solver sessions are answered from the compile-time solution table, which is
+read-only and shared by all sessions and threads without locking
+minimax and alfa-beta moves are kept in a result cache shared by all sessions, many games
+reach the same positions, a cached move is found under a shared lock, so threads only
+wait for each other while a move is added
+monte carlo tree search is time limited and random, so its moves are not cached
+*/
+class EngineService {
+public:
+    // called on a pool thread after the computer's move is made
+    typedef function<void(int sessionId, const MoveResult&)> MoveCallback;
+
+private:
+    struct Session {
+        State state;
+        bool isComputerMax;          // computer moved first
+        SearchSettings settings;
+        deque<MoveCallback> requests;  // waiting move requests
+        bool isQueued = false;         // session is in ready queue or being searched
+        bool isClosed = false;         // removed after current search
+        int moveCount = 0;             // computer's moves
+        long long totalNodeCount = 0;
+    };
+
+    // search that gives the same move, numbers are packed, so their order doesn't matter
+    struct CacheKey {
+        PackedState state;
+        bool isMaxPlayer;
+        int algorithmType, depth;
+        size_t memoryBudget;
+
+        bool operator==(const CacheKey& key) const {
+            return state == key.state && isMaxPlayer == key.isMaxPlayer && algorithmType == key.algorithmType &&
+                   depth == key.depth && memoryBudget == key.memoryBudget;
+        }
+    };
+
+    struct CacheKeyHash {
+        size_t operator()(const CacheKey& key) const {
+            size_t settings = (size_t(key.depth) << 4 | size_t(key.algorithmType) << 1 | key.isMaxPlayer) ^
+                              key.memoryBudget;
+            return hash<PackedState>()(key.state) ^ settings * 0x9e3779b97f4a7c15ULL;
+        }
+    };
+
+    // move of a cached search, made again on the session's state
+    struct CachedMove {
+        int number;
+        bool divide;
+        int value, treeDepth;
+    };
+
+    static constexpr size_t MAX_CACHE_SIZE = 1 << 20;  // entries kept before the cache is cleared
+
+    shared_mutex cacheMutex;
+    unordered_map<CacheKey, CachedMove, CacheKeyHash> resultCache;
+    atomic<long long> cacheHitCount{0};
+
+    mutex sessionMutex;
+    condition_variable requestReady;
+    unordered_map<int, Session> sessions;
+    deque<int> readySessions;  // sessions with requests, in turn order
+    vector<thread> workers;
+    int nextSessionId = 0;
+    bool isStopped = false;
+
+    // searches move, minimax and alfa-beta moves are taken from and added to the result cache
+    MoveResult search(State state, bool isMaxPlayer, const SearchSettings& settings) {
+        if (settings.algorithmType != 1 && settings.algorithmType != 2)
+            return searchMove(state, isMaxPlayer, settings);
+
+        auto startTime = chrono::steady_clock::now();
+        CacheKey key = {packState(state), isMaxPlayer, settings.algorithmType, settings.depth, settings.memoryBudget};
+        {
+            shared_lock<shared_mutex> lock(cacheMutex);
+            auto cached = resultCache.find(key);
+            if (cached != resultCache.end()) {
+                cacheHitCount++;
+                MoveResult result;
+                result.bestState = state;
+                result.bestState.doAction(cached->second.number, cached->second.divide);
+                result.value = cached->second.value;
+                result.treeDepth = cached->second.treeDepth;
+                result.nodeCount = 0;
+                result.treeMemory = 0;
+                result.isStopped = false;
+                result.time = chrono::duration<double>(chrono::steady_clock::now() - startTime).count();
+                return result;
+            }
+        }
+
+        MoveResult result = searchMove(state, isMaxPlayer, settings);
+
+        // move that leads to best state, end state has none
+        for (int number : state.getUniqueNumbers()) {
+            for (bool divide : {false, true}) {
+                if (divide && number != 2 && number != 4) continue;
+
+                State childState = state;
+                childState.doAction(number, divide);
+                if (childState == result.bestState) {
+                    unique_lock<shared_mutex> lock(cacheMutex);
+                    if (resultCache.size() >= MAX_CACHE_SIZE)
+                        resultCache.clear();
+                    resultCache.emplace(key, CachedMove{number, divide, result.value, result.treeDepth});
+                    return result;
+                }
+            }
+        }
+        return result;
+    }
+
+    void work() {
+        unique_lock<mutex> lock(sessionMutex);
+
+        while (true) {
+            requestReady.wait(lock, [this] { return isStopped || !readySessions.empty(); });
+            if (readySessions.empty()) return;
+
+            int sessionId = readySessions.front();
+            readySessions.pop_front();
+
+            Session& session = sessions.at(sessionId);
+            if (session.isClosed) {
+                sessions.erase(sessionId);
+                continue;
+            }
+
+            MoveCallback callback = move(session.requests.front());
+            session.requests.pop_front();
+            State state = session.state;
+            bool isMaxPlayer = session.isComputerMax;
+            SearchSettings settings = session.settings;
+
+            // search without lock, session stays out of ready queue meanwhile
+            lock.unlock();
+            MoveResult result = search(state, isMaxPlayer, settings);
+            lock.lock();
+
+            session.state = result.bestState;
+            session.moveCount++;
+            session.totalNodeCount += result.nodeCount;
+
+            if (session.isClosed) {
+                sessions.erase(sessionId);
+                continue;
+            }
+
+            // next request of this session waits for other sessions
+            if (!session.requests.empty()) {
+                readySessions.push_back(sessionId);
+                requestReady.notify_one();
+            } else {
+                session.isQueued = false;
+            }
+
+            lock.unlock();
+            if (callback) callback(sessionId, result);
+            lock.lock();
+        }
+    }
+
+public:
+    // threadCount 0 uses all cores
+    EngineService(int threadCount = 0) {
+        if (threadCount <= 0)
+            threadCount = max(1u, thread::hardware_concurrency());
+
+        for (int i = 0; i < threadCount; i++) {
+            workers.emplace_back(&EngineService::work, this);
+        }
+    }
+
+    // waits for queued requests to finish
+    ~EngineService() {
+        {
+            lock_guard<mutex> lock(sessionMutex);
+            isStopped = true;
+        }
+        requestReady.notify_all();
+
+        for (thread& worker : workers) {
+            worker.join();
+        }
+    }
+
+    EngineService(const EngineService&) = delete;
+    EngineService& operator=(const EngineService&) = delete;
+
+    // starts a game, returns session id
+    int openSession(State state, bool isComputerFirst, SearchSettings settings) {
+        lock_guard<mutex> lock(sessionMutex);
+
+        int sessionId = nextSessionId++;
+        Session& session = sessions[sessionId];
+        session.state = state;
+        session.isComputerMax = isComputerFirst;
+        session.settings = settings;
+
+        return sessionId;
+    }
+
+    // ends a game, waiting requests are dropped
+    void closeSession(int sessionId) {
+        lock_guard<mutex> lock(sessionMutex);
+
+        auto session = sessions.find(sessionId);
+        if (session == sessions.end()) return;
+
+        session->second.requests.clear();
+        if (session->second.isQueued) {
+            session->second.isClosed = true;
+        } else {
+            sessions.erase(session);
+        }
+    }
+
+    // queues search of computer's move in session's current state
+    // requests of one session are searched one after another
+    void requestMove(int sessionId, MoveCallback callback) {
+        lock_guard<mutex> lock(sessionMutex);
+
+        Session& session = sessions.at(sessionId);
+        session.requests.push_back(move(callback));
+
+        if (!session.isQueued) {
+            session.isQueued = true;
+            readySessions.push_back(sessionId);
+            requestReady.notify_one();
+        }
+    }
+
+    // makes user's move, returns false if move isn't possible
+    // or while session's computer move is queued or searched, it would change the searched state
+    bool makeMove(int sessionId, int number, bool divide) {
+        lock_guard<mutex> lock(sessionMutex);
+
+        Session& session = sessions.at(sessionId);
+        if (session.isQueued)
+            return false;
+
+        State& state = session.state;
+        if (!state.validateNumber(number) || (divide && number != 2 && number != 4))
+            return false;
+
+        state.doAction(number, divide);
+        return true;
+    }
+
+    State getState(int sessionId) {
+        lock_guard<mutex> lock(sessionMutex);
+        return sessions.at(sessionId).state;
+    }
+
+    int getMoveCount(int sessionId) {
+        lock_guard<mutex> lock(sessionMutex);
+        return sessions.at(sessionId).moveCount;
+    }
+
+    long long getNodeCount(int sessionId) {
+        lock_guard<mutex> lock(sessionMutex);
+        return sessions.at(sessionId).totalNodeCount;
+    }
+
+    int getSessionCount() {
+        lock_guard<mutex> lock(sessionMutex);
+        return sessions.size();
+    }
+
+    // moves answered from the result cache
+    long long getCacheHitCount() const { return cacheHitCount; }
+
+    int getThreadCount() const { return workers.size(); }
+};
+
+#endif // SERVICE_H
@@ -0,0 +1,435 @@
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <new>
+#include <thread>
+#include "solver.h"
+
+#ifndef _WIN32
+#include <csignal>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+/*
+exhaustive solve of every position up to a sequence length, sharded over worker processes
+
+usage: shard [--length L] [--workers W] [--verify 0|1] [--output file]
+a position is a count of every number, number sum never grows (4 divides into 2 + 2,
+2 into 1 + 1), so all positions of sequences up to length L have sum at most 4 L
+one byte holds all 8 values of a position, bit points parity * 4 + bank parity * 2 + max player
+is set for value 10 and clear for -10, full depth values are only end state values
+
+positions are sharded by counts of 4 and 2, a move keeps both counts or lowers count of 4,
+or keeps count of 4 and lowers count of 2, so shard (fours, twos) only needs its own
+positions with fewer 1 and 3 and shards (fours, twos - 1), (fours - 1, twos) and
+(fours - 1, twos + 2), and shards with equal 3 fours + twos are independent
+every shard is its own named shared memory segment, worker processes take shards in that
+order, wait for the shards they read to be done and map only those, so the table isn't
+limited by one process's address space or allocator
+a small anonymous segment holds the shard queue, done flags and an abort flag, a worker
+that fails sets the flag, so the others stop waiting, and the parent kills the rest
+with verify every value is compared to the exact solver
+output writes the table, shards in solving order, positions by count of 3, then count of 1
+*/
+
+// one shard, positions with given counts of 4 and 2
+struct Shard {
+    int fours, twos;
+    int rest;       // highest sum of 1 and 3 counts: ones + 3 threes
+    size_t offset;  // first position in output
+};
+
+// anonymous shared memory segment, followed by shard done flags
+struct Control {
+    atomic<int> nextShard;         // next shard to take, in solving order
+    atomic<long long> errorCount;  // values different from the exact solver
+    atomic<int> isAborted;         // a worker failed, others stop
+};
+
+// positions of a shard before the given count of 3
+inline size_t rowOffset(int rest, int threes) {
+    return size_t(threes) * (rest + 1) - size_t(3) * threes * (threes - 1) / 2;
+}
+
+inline size_t shardSize(int rest) {
+    return rowOffset(rest, rest / 3 + 1);
+}
+
+class ShardedSolver {
+private:
+    int maxSum;
+    vector<Shard> shards;           // in solving order
+    vector<vector<int>> shardIndex;  // index in shards by [fours][twos], -1 if none
+    size_t positionCount = 0;
+
+    Control* control = nullptr;
+    atomic<int>* doneFlags = nullptr;
+    size_t controlSize = 0;
+    int parentId = 0;  // process id in shard segment names
+    bool isCreated = false;  // shard segments may exist and have to be removed
+
+    const Shard* findShard(int fours, int twos) const {
+        if (fours < 0 || twos < 0 || fours >= int(shardIndex.size()) || twos >= int(shardIndex[fours].size()))
+            return nullptr;
+        return &shards[shardIndex[fours][twos]];
+    }
+
+    // values byte of a position in a mapped shard
+    static uint8_t values(const Shard& shard, const uint8_t* table, int ones, int threes) {
+        return table[rowOffset(shard.rest, threes) + ones];
+    }
+
+    // returns false if solving was aborted meanwhile
+    bool waitForShard(const Shard* shard) const {
+        if (!shard) return true;
+        while (!doneFlags[shard - shards.data()].load(memory_order_acquire)) {
+            if (control->isAborted.load()) return false;
+            this_thread::yield();
+        }
+        return true;
+    }
+
+#ifndef _WIN32
+    string segmentName(const Shard& shard) const {
+        return "/shard-" + to_string(parentId) + "-" + to_string(&shard - shards.data());
+    }
+
+    // maps shard's segment, a new one is created for writing, returns nullptr on failure
+    uint8_t* mapShard(const Shard* shard, bool isNew) const {
+        if (!shard) return nullptr;
+
+        string name = segmentName(*shard);
+        size_t size = shardSize(shard->rest);
+        int file = isNew ? shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600)
+                         : shm_open(name.c_str(), O_RDONLY, 0);
+        if (file < 0) return nullptr;
+        if (isNew && ftruncate(file, size) != 0) {
+            close(file);
+            return nullptr;
+        }
+
+        void* memory = mmap(nullptr, size, isNew ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, file, 0);
+        close(file);
+        return memory == MAP_FAILED ? nullptr : static_cast<uint8_t*>(memory);
+    }
+
+    static void unmapShard(const Shard* shard, uint8_t* table) {
+        if (shard && table) munmap(table, shardSize(shard->rest));
+    }
+
+    // solves all positions of a shard, shards it reads have to be done
+    // returns false if a segment can't be mapped
+    bool solveShard(const Shard& shard, bool isVerified) {
+        const Shard* fewerTwos = findShard(shard.fours, shard.twos - 1);
+        const Shard* fewerFours = findShard(shard.fours - 1, shard.twos);
+        const Shard* dividedFour = findShard(shard.fours - 1, shard.twos + 2);
+
+        uint8_t* table = mapShard(&shard, true);
+        uint8_t* fewerTwosTable = shard.twos > 0 ? mapShard(fewerTwos, false) : nullptr;
+        uint8_t* fewerFoursTable = shard.fours > 0 ? mapShard(fewerFours, false) : nullptr;
+        uint8_t* dividedFourTable = shard.fours > 0 ? mapShard(dividedFour, false) : nullptr;
+        bool isMapped = table && (shard.twos == 0 || fewerTwosTable) &&
+                        (shard.fours == 0 || (fewerFoursTable && dividedFourTable));
+
+        if (isMapped)
+            solvePositions(shard, isVerified, table, fewerTwosTable, fewerFoursTable, dividedFourTable);
+
+        unmapShard(&shard, table);
+        unmapShard(fewerTwos, fewerTwosTable);
+        unmapShard(fewerFours, fewerFoursTable);
+        unmapShard(dividedFour, dividedFourTable);
+        return isMapped;
+    }
+#endif
+
+    void solvePositions(const Shard& shard, bool isVerified, uint8_t* table, const uint8_t* fewerTwosTable,
+                        const uint8_t* fewerFoursTable, const uint8_t* dividedFourTable) {
+        const Shard* fewerTwos = findShard(shard.fours, shard.twos - 1);
+        const Shard* fewerFours = findShard(shard.fours - 1, shard.twos);
+        const Shard* dividedFour = findShard(shard.fours - 1, shard.twos + 2);
+        long long errorCount = 0;
+
+        for (int threes = 0; 3 * threes <= shard.rest; threes++) {
+            for (int ones = 0; ones + 3 * threes <= shard.rest; ones++) {
+                // child value bytes, points or bank parity of a child is flipped by the move
+                uint8_t children[6];
+                int flips[6];  // 4 flips points parity, 2 flips bank parity
+                int childCount = 0;
+
+                if (ones > 0) {
+                    children[childCount] = values(shard, table, ones - 1, threes);
+                    flips[childCount++] = 4;
+                }
+                if (threes > 0) {
+                    children[childCount] = values(shard, table, ones, threes - 1);
+                    flips[childCount++] = 4;
+                }
+                if (shard.twos > 0) {
+                    children[childCount] = values(*fewerTwos, fewerTwosTable, ones, threes);
+                    flips[childCount++] = 0;
+                    children[childCount] = values(*fewerTwos, fewerTwosTable, ones + 2, threes);
+                    flips[childCount++] = 2;
+                }
+                if (shard.fours > 0) {
+                    children[childCount] = values(*fewerFours, fewerFoursTable, ones, threes);
+                    flips[childCount++] = 0;
+                    children[childCount] = values(*dividedFour, dividedFourTable, ones, threes);
+                    flips[childCount++] = 0;
+                }
+
+                uint8_t result = 0;
+                for (int parity = 0; parity < 4; parity++) {
+                    for (int isMax = 0; isMax < 2; isMax++) {
+                        int bit = parity * 2 + isMax;
+                        bool isWin;
+
+                        // end state value depends only on bank parity
+                        if (childCount == 0) {
+                            isWin = (parity & 1) == 0;
+                        } else {
+                            // max player needs one winning child, min player all of them
+                            // child position is searched by the other player
+                            isWin = !isMax;
+                            for (int i = 0; i < childCount; i++) {
+                                int childBit = ((parity * 2) ^ flips[i]) + !isMax;
+                                bool isChildWin = children[i] >> childBit & 1;
+                                isWin = isMax ? isWin || isChildWin : isWin && isChildWin;
+                            }
+                        }
+
+                        if (isWin) result |= 1 << bit;
+
+                        if (isVerified) {
+                            map<int, int> numbers = {{1, ones}, {2, shard.twos}, {3, threes}, {4, shard.fours}};
+                            State state(numbers, parity >> 1, parity & 1);
+                            if (::solve(state, isMax) != (isWin ? 10 : -10))
+                                errorCount++;
+                        }
+                    }
+                }
+
+                table[rowOffset(shard.rest, threes) + ones] = result;
+            }
+        }
+
+        if (errorCount > 0)
+            control->errorCount += errorCount;
+    }
+
+#ifndef _WIN32
+    // returns false if solving failed or was aborted
+    bool work(bool isVerified) {
+        while (true) {
+            int index = control->nextShard++;
+            if (index >= int(shards.size())) return true;
+
+            const Shard& shard = shards[index];
+            if (!waitForShard(findShard(shard.fours, shard.twos - 1)) ||
+                !waitForShard(findShard(shard.fours - 1, shard.twos)) ||
+                !waitForShard(findShard(shard.fours - 1, shard.twos + 2)))
+                return false;
+
+            if (!solveShard(shard, isVerified)) {
+                control->isAborted = 1;
+                return false;
+            }
+            doneFlags[index].store(1, memory_order_release);
+        }
+    }
+
+    // waits for all workers, when one fails the others are stopped
+    bool waitForWorkers(vector<pid_t> workers) {
+        bool isFailed = false;
+        while (!workers.empty()) {
+            int status;
+            pid_t pid = waitpid(-1, &status, WNOHANG);
+            if (pid == 0) {
+                this_thread::sleep_for(chrono::milliseconds(10));
+                continue;
+            }
+            if (pid < 0) return false;
+
+            auto worker = find(workers.begin(), workers.end(), pid);
+            if (worker == workers.end()) continue;
+            workers.erase(worker);
+
+            if (!isFailed && (!WIFEXITED(status) || WEXITSTATUS(status) != 0)) {
+                isFailed = true;
+                control->isAborted = 1;
+                for (pid_t other : workers) {
+                    kill(other, SIGKILL);
+                }
+            }
+        }
+        return !isFailed;
+    }
+
+    void removeShards() {
+        if (!isCreated) return;
+        for (const Shard& shard : shards) {
+            shm_unlink(segmentName(shard).c_str());
+        }
+        isCreated = false;
+    }
+#endif
+
+public:
+    ShardedSolver(int maxLength) : maxSum(4 * maxLength) {
+        // shards in order of 3 fours + twos, every shard comes after the shards it reads
+        for (int weight = 0; weight <= 3 * (maxSum / 4) + maxSum / 2; weight++) {
+            for (int fours = 0; 3 * fours <= weight; fours++) {
+                int twos = weight - 3 * fours;
+                if (4 * fours + 2 * twos > maxSum) continue;
+
+                int rest = maxSum - 4 * fours - 2 * twos;
+                shards.push_back({fours, twos, rest, positionCount});
+                positionCount += shardSize(rest);
+            }
+        }
+
+        shardIndex.assign(maxSum / 4 + 1, vector<int>());
+        for (int fours = 0; fours <= maxSum / 4; fours++) {
+            shardIndex[fours].assign((maxSum - 4 * fours) / 2 + 1, -1);
+        }
+        for (size_t i = 0; i < shards.size(); i++) {
+            shardIndex[shards[i].fours][shards[i].twos] = i;
+        }
+    }
+
+    ~ShardedSolver() {
+#ifndef _WIN32
+        removeShards();
+        if (control) munmap(control, controlSize);
+#endif
+    }
+
+    ShardedSolver(const ShardedSolver&) = delete;
+    ShardedSolver& operator=(const ShardedSolver&) = delete;
+
+    // solves all shards with given number of worker processes
+    // returns number of values different from the exact solver, -1 if workers failed
+    long long solve(int workerCount, bool isVerified) {
+#ifdef _WIN32
+        cerr << "sharded solving needs fork and shared memory, not available on Windows" << endl;
+        return -1;
+#else
+        controlSize = sizeof(Control) + shards.size() * sizeof(atomic<int>);
+        void* memory = mmap(nullptr, controlSize, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_ANONYMOUS, -1, 0);
+        if (memory == MAP_FAILED) {
+            cerr << "can't map " << controlSize << " bytes of shared memory" << endl;
+            return -1;
+        }
+
+        // atomics are lock free, so they work across processes
+        control = new (memory) Control();
+        control->nextShard = 0;
+        control->errorCount = 0;
+        control->isAborted = 0;
+        doneFlags = reinterpret_cast<atomic<int>*>(control + 1);
+        for (size_t i = 0; i < shards.size(); i++) {
+            new (&doneFlags[i]) atomic<int>(0);
+        }
+
+        parentId = getpid();
+        isCreated = true;
+
+        vector<pid_t> workers;
+        for (int i = 0; i < workerCount; i++) {
+            pid_t pid = fork();
+            if (pid == 0) {
+                _exit(work(isVerified) ? 0 : 1);
+            }
+            if (pid < 0) {
+                cerr << "can't start worker process" << endl;
+                break;
+            }
+            workers.push_back(pid);
+        }
+
+        // without workers shards are solved in this process
+        bool isFailed = workers.empty() ? !work(isVerified) : !waitForWorkers(workers);
+
+        // a failed worker may have left a shard unsolved
+        for (size_t i = 0; i < shards.size(); i++) {
+            if (!doneFlags[i].load()) isFailed = true;
+        }
+
+        if (isFailed) {
+            cerr << "a worker failed or couldn't map a shared memory segment" << endl;
+            removeShards();
+            return -1;
+        }
+        return control->errorCount.load();
+#endif
+    }
+
+    // writes solved shards in order, returns false if a shard can't be read
+    bool write(ostream& out) const {
+#ifdef _WIN32
+        return false;
+#else
+        for (const Shard& shard : shards) {
+            uint8_t* table = mapShard(&shard, false);
+            if (!table) return false;
+            out.write(reinterpret_cast<const char*>(table), shardSize(shard.rest));
+            unmapShard(&shard, table);
+        }
+        return bool(out);
+#endif
+    }
+
+    int getShardCount() const { return shards.size(); }
+    size_t getPositionCount() const { return positionCount; }
+    size_t getSharedSize() const { return controlSize + positionCount; }
+};
+
+int main(int argc, char *argv[]) {
+    int maxLength = 30;
+    int workerCount = max(1u, thread::hardware_concurrency());
+    bool isVerified = true;
+    string outputPath;
+
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (strcmp(argv[i], "--length") == 0) maxLength = atoi(argv[i + 1]);
+        else if (strcmp(argv[i], "--workers") == 0) workerCount = atoi(argv[i + 1]);
+        else if (strcmp(argv[i], "--verify") == 0) isVerified = atoi(argv[i + 1]) != 0;
+        else if (strcmp(argv[i], "--output") == 0) outputPath = argv[i + 1];
+    }
+
+    ShardedSolver solver(maxLength);
+    auto start = chrono::steady_clock::now();
+    long long errorCount = solver.solve(workerCount, isVerified);
+    double time = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    if (errorCount < 0) {
+        cout << "solving failed" << endl;
+        return 1;
+    }
+
+    cout << "length " << maxLength << ", " << workerCount << " workers, " << solver.getShardCount() << " shards, "
+         << solver.getPositionCount() << " positions, " << fixed << setprecision(1)
+         << solver.getSharedSize() / 1024.0 / 1024.0 << " MB shared" << endl;
+    cout << setprecision(2) << time << " s";
+    if (isVerified)
+        cout << ", " << errorCount << " values different from solver";
+    cout << endl;
+
+    if (!outputPath.empty()) {
+        ofstream file(outputPath, ios::binary);
+        if (!solver.write(file)) {
+            cout << "can't write " << outputPath << endl;
+            return 1;
+        }
+    }
+
+    return errorCount == 0 ? 0 : 1;
+}
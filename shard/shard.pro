@@ -0,0 +1,26 @@
+TEMPLATE = app
+TARGET = shard
+
+QT -= core gui
+
+CONFIG += c++17 console thread
+CONFIG -= app_bundle
+
+# solution table in table.h is generated at compile time
+msvc: QMAKE_CXXFLAGS += /constexpr:steps10000000
+
+INCLUDEPATH += ..
+
+# shm_open is in librt on older glibc
+unix:!macx: LIBS += -lrt
+
+SOURCES += \
+    shard.cpp
+
+HEADERS += \
+    ../leafbatch.h \
+    ../solver.h \
+    ../state.h \
+    ../table.h \
+    ../trace.h \
+    ../tree.h
@@ -0,0 +1,121 @@
+#ifndef SOLVER_H
+#define SOLVER_H
+
+#include <iostream>
+#include "tree.h"
+#include "table.h"
+
+using namespace std;
+
+/*
+exact solver, returns the same value as minimax over the full tree without searching
+
+at an end state heuristic value depends only on bank parity (even = 10, odd = -10),
+bank changes only when 2 is divided, so the game is decided by counts of 2 and 4
+and by who makes the last move, which depends on total number count parity
+*/
+inline int solve(State state, bool isMaxPlayer) {
+    map<int, int> numbers = state.getNumberMap();
+    int twos = numbers[2];
+    int fours = numbers[4];
+    int total = numbers[1] + numbers[2] + numbers[3] + numbers[4];
+    bool isBankEven = state.isEven(state.getBank());
+
+    // bank can't change anymore, outcome is fixed
+    if (twos + fours == 0)
+        return isBankEven ? 10 : -10;
+
+    // last 2, current player chooses bank parity
+    if (twos == 1 && fours == 0)
+        return isMaxPlayer ? 10 : -10;
+
+    // last 4, current player removes it if bank parity already suits them
+    if (twos == 0 && fours == 1 && isBankEven == isMaxPlayer)
+        return isMaxPlayer ? 10 : -10;
+
+    // otherwise outcome depends on total number count parity
+    return (!state.isEven(total) == isMaxPlayer) ? 10 : -10;
+}
+
+// returns state after the optimal move, first best child as in minimax
+inline State solveMove(State state, bool isMaxPlayer) {
+    int optimalValue = solve(state, isMaxPlayer);
+    vector<State> states = Tree::generateChildStates(state);
+
+    for (State childState : states) {
+        if (solve(childState, !isMaxPlayer) == optimalValue)
+            return childState;
+    }
+
+    return state;
+}
+
+// full minimax over state graph, values of repeated states are cached
+// same value as minimax over a fully generated tree
+inline int exhaustiveMinimax(State state, bool isMaxPlayer, map<pair<State, bool>, int>& cache) {
+    if (state.hasFinished())
+        return state.heuristicValue();
+
+    auto result = cache.find({state, isMaxPlayer});
+    if (result != cache.end())
+        return result->second;
+
+    int bestValue = isMaxPlayer ? MIN : MAX;
+    for (State childState : Tree::generateChildStates(state)) {
+        int value = exhaustiveMinimax(childState, !isMaxPlayer, cache);
+        bestValue = isMaxPlayer ? max(bestValue, value) : min(bestValue, value);
+    }
+
+    cache.emplace(make_pair(state, isMaxPlayer), bestValue);
+    return bestValue;
+}
+
+// checks solver and solution table against exhaustive minimax for all positions up to given length
+// returns number of mismatches
+inline int verifySolver(int maxLength, ostream& out) {
+    map<pair<State, bool>, int> cache;  // shared by all positions
+    int positionCount = 0;
+    int errorCount = 0;
+
+    for (int length = 1; length <= maxLength; length++) {
+        for (int ones = 0; ones <= length; ones++) {
+            for (int twos = 0; ones + twos <= length; twos++) {
+                for (int threes = 0; ones + twos + threes <= length; threes++) {
+                    int fours = length - ones - twos - threes;
+                    map<int, int> numbers = {{1, ones}, {2, twos}, {3, threes}, {4, fours}};
+
+                    for (int points = 0; points < 2; points++) {
+                        for (int bank = 0; bank < 2; bank++) {
+                            for (bool isMaxPlayer : {true, false}) {
+                                State state(numbers, points, bank);
+
+                                int value = exhaustiveMinimax(state, isMaxPlayer, cache);
+                                int solvedValue = solve(state, isMaxPlayer);
+                                int storedValue = isInSolutionTable(state) ? tableValue(state, isMaxPlayer) : value;
+
+                                // solver's move has to lead to a state with the same value
+                                State bestState = solveMove(state, isMaxPlayer);
+                                int moveValue = exhaustiveMinimax(bestState, !isMaxPlayer, cache);
+
+                                positionCount++;
+                                if (value != solvedValue || value != storedValue || moveValue != value) {
+                                    errorCount++;
+                                    out << "mismatch: " << ones << " " << twos << " " << threes << " " << fours
+                                        << " points " << points << " bank " << bank
+                                        << (isMaxPlayer ? " max" : " min")
+                                        << " minimax " << value << " solver " << solvedValue << " table " << storedValue
+                                        << " move " << moveValue << endl;
+                                }
+                            }
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    out << positionCount << " positions checked, " << errorCount << " mismatches" << endl;
+    return errorCount;
+}
+
+#endif // SOLVER_H
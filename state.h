@@ -3,9 +3,13 @@
 
 #include <vector>
 #include <map>
+#include <limits>
 
 using namespace std;
 
+const int MAX = numeric_limits<int>::max();  // highest possible value
+const int MIN = numeric_limits<int>::min();  // lowest possible value
+
 // game state class
 class State {
 private:
@@ -32,6 +36,19 @@ public:
         }
     }
 
+    // creates state from number counts, points and bank
+    State(map<int, int> numbers, int points, int bank) : points(points), bank(bank) {
+        this->numbers[1] = 0;
+        this->numbers[2] = 0;
+        this->numbers[3] = 0;
+        this->numbers[4] = 0;
+
+        for (const auto& pair : numbers) {
+            if (pair.first >= 1 && pair.first <= 4)
+                this->numbers[pair.first] = pair.second;
+        }
+    }
+
     State(int length) : points(0), bank(0) {
         int number;
         numbers[1] = 0;
@@ -191,12 +208,25 @@ public:
         return tempNumbers;
     }
 
+    // bytes used by a state, including its number map nodes
+    static size_t getMemorySize() {
+        return sizeof(State) + 4 * mapNodeSize<pair<const int, int>>();
+    }
+
+    // bytes used by one red-black tree node holding given value
+    // (color, parent, left and right pointers, value)
+    template <typename T>
+    static constexpr size_t mapNodeSize() {
+        return 4 * sizeof(void*) + sizeof(T);
+    }
+
     map<int, int> getNumberMap() {
         return numbers;
     }
 
-    int getPoints() { return points; }
-    int getBank() { return bank; }
+    int getPoints() const { return points; }
+    int getBank() const { return bank; }
+    int getCount(int number) const { return numbers.at(number); }
 
     bool validateNumber(int number) {
         for (const auto& pair : numbers) {
@@ -0,0 +1,107 @@
+#ifndef TABLE_H
+#define TABLE_H
+
+#include "state.h"
+#include "tree.h"
+
+using namespace std;
+
+/*
+solution table for sequences up to TABLE_LENGTH, generated at compile time
+
+final value depends only on bank parity, so points are left out and 1 and 3 are
+counted together, as removing either has the same effect on the outcome
+every move keeps or lowers weight = ones + threes + 2 * twos + 4 * fours,
+so the table is filled by weight, then by fours and twos within the same weight
+*/
+const int TABLE_LENGTH = 20;                           // longest sequence on sliderLength
+const int TABLE_WEIGHT = 4 * TABLE_LENGTH;             // highest possible weight
+const int TABLE_SINGLES = TABLE_WEIGHT;                // highest ones + threes count
+const int TABLE_TWOS = TABLE_WEIGHT / 2;               // highest twos count
+const int TABLE_FOURS = TABLE_LENGTH;                  // highest fours count
+
+struct SolutionTable {
+    // [ones + threes][twos][fours][bank parity][is max player]
+    signed char values[TABLE_SINGLES + 1][TABLE_TWOS + 1][TABLE_FOURS + 1][2][2];
+};
+
+constexpr SolutionTable generateSolutionTable() {
+    SolutionTable table{};
+
+    for (int weight = 0; weight <= TABLE_WEIGHT; weight++) {
+        for (int fours = 0; fours <= TABLE_FOURS && 4 * fours <= weight; fours++) {
+            for (int twos = 0; twos <= TABLE_TWOS && 4 * fours + 2 * twos <= weight; twos++) {
+                int singles = weight - 4 * fours - 2 * twos;
+                if (singles > TABLE_SINGLES) continue;
+
+                for (int bank = 0; bank < 2; bank++) {
+                    for (int isMax = 0; isMax < 2; isMax++) {
+                        // end state, bank parity decides
+                        if (singles + twos + fours == 0) {
+                            table.values[0][0][0][bank][isMax] = bank ? -10 : 10;
+                            continue;
+                        }
+
+                        int bestValue = isMax ? -10 : 10;
+                        int values[5] = {};
+                        int count = 0;
+
+                        // remove 1 or 3
+                        if (singles > 0)
+                            values[count++] = table.values[singles - 1][twos][fours][bank][!isMax];
+                        // remove or divide 2
+                        if (twos > 0) {
+                            values[count++] = table.values[singles][twos - 1][fours][bank][!isMax];
+                            values[count++] = table.values[singles + 2][twos - 1][fours][!bank][!isMax];
+                        }
+                        // remove or divide 4
+                        if (fours > 0) {
+                            values[count++] = table.values[singles][twos][fours - 1][bank][!isMax];
+                            values[count++] = table.values[singles][twos + 2][fours - 1][bank][!isMax];
+                        }
+
+                        for (int i = 0; i < count; i++) {
+                            if (isMax ? values[i] > bestValue : values[i] < bestValue)
+                                bestValue = values[i];
+                        }
+
+                        table.values[singles][twos][fours][bank][isMax] = bestValue;
+                    }
+                }
+            }
+        }
+    }
+
+    return table;
+}
+
+inline constexpr SolutionTable solutionTable = generateSolutionTable();
+
+// checks if state is covered by the solution table
+inline bool isInSolutionTable(State state) {
+    map<int, int> numbers = state.getNumberMap();
+    int weight = numbers[1] + numbers[3] + 2 * numbers[2] + 4 * numbers[4];
+    return weight <= TABLE_WEIGHT;
+}
+
+// returns full depth value of state from the solution table
+inline int tableValue(State state, bool isMaxPlayer) {
+    map<int, int> numbers = state.getNumberMap();
+    int bank = state.isEven(state.getBank()) ? 0 : 1;
+    return solutionTable.values[numbers[1] + numbers[3]][numbers[2]][numbers[4]][bank][isMaxPlayer];
+}
+
+// returns state after the optimal move, first best child as in minimax
+inline State tableMove(State state, bool isMaxPlayer) {
+    int optimalValue = tableValue(state, isMaxPlayer);
+    vector<State> states = Tree::generateChildStates(state);
+
+    for (State childState : states) {
+        if (tableValue(childState, !isMaxPlayer) == optimalValue)
+            return childState;
+    }
+
+    return state;
+}
+
+#endif // TABLE_H
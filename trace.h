@@ -0,0 +1,131 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <ostream>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+/*
+optional timeline of search phases, written in Chrome trace JSON format,
+which chrome://tracing and Perfetto open
+
+TRACE_ZONE(name) records the time from its line to the end of the enclosing block
+while tracing is off a zone only reads one atomic flag, defining TRACE_DISABLED
+removes zones at compile time
+events are kept in memory until the trace is written, at most MAX_EVENTS
+*/
+class Trace {
+public:
+    struct Event {
+        const char* name;  // zone name, string literal
+        int argument;      // shown in event details, -1 if none
+        int threadId;      // small thread number, 0 = first traced thread
+        double start;      // microseconds from trace start
+        double duration;   // microseconds
+    };
+
+    static constexpr size_t MAX_EVENTS = 1 << 22;
+
+    static bool isEnabled() {
+        return enabled().load(memory_order_relaxed);
+    }
+
+    // starts recording, previous events are removed
+    static void start() {
+        lock_guard<mutex> lock(eventMutex());
+        events().clear();
+        droppedCount() = 0;
+        startTime() = chrono::steady_clock::now();
+        enabled() = true;
+    }
+
+    static void stop() {
+        enabled() = false;
+    }
+
+    static double now() {
+        return chrono::duration<double, micro>(chrono::steady_clock::now() - startTime()).count();
+    }
+
+    static void add(const Event& event) {
+        lock_guard<mutex> lock(eventMutex());
+        if (events().size() < MAX_EVENTS) {
+            events().push_back(event);
+        } else {
+            droppedCount()++;
+        }
+    }
+
+    // small number of calling thread, assigned on first use
+    static int threadId() {
+        static atomic<int> nextId{0};
+        thread_local int id = nextId++;
+        return id;
+    }
+
+    // writes recorded events as complete ("X") events
+    static void write(ostream& out) {
+        lock_guard<mutex> lock(eventMutex());
+
+        out << "{\"traceEvents\": [\n";
+        for (size_t i = 0; i < events().size(); i++) {
+            const Event& event = events()[i];
+            out << "{\"name\": \"" << event.name << "\", \"ph\": \"X\", \"pid\": 1, \"tid\": " << event.threadId
+                << ", \"ts\": " << event.start << ", \"dur\": " << event.duration;
+            if (event.argument >= 0) {
+                out << ", \"args\": {\"value\": " << event.argument << "}";
+            }
+            out << "}" << (i + 1 < events().size() ? ",\n" : "\n");
+        }
+        out << "], \"displayTimeUnit\": \"ms\", \"otherData\": {\"dropped\": " << droppedCount() << "}}\n";
+    }
+
+private:
+    // function statics, so the header can be included in every translation unit
+    static atomic<bool>& enabled() { static atomic<bool> value{false}; return value; }
+    static mutex& eventMutex() { static mutex value; return value; }
+    static vector<Event>& events() { static vector<Event> value; return value; }
+    static size_t& droppedCount() { static size_t value = 0; return value; }
+    static chrono::steady_clock::time_point& startTime() {
+        static chrono::steady_clock::time_point value = chrono::steady_clock::now();
+        return value;
+    }
+};
+
+// records one zone, from construction to destruction
+class TraceZone {
+private:
+    const char* name;
+    int argument;
+    double start;
+
+public:
+    TraceZone(const char* name, int argument = -1) : name(name), argument(argument), start(-1) {
+        if (Trace::isEnabled())
+            start = Trace::now();
+    }
+
+    ~TraceZone() {
+        if (start >= 0)
+            Trace::add({name, argument, Trace::threadId(), start, Trace::now() - start});
+    }
+
+    TraceZone(const TraceZone&) = delete;
+    TraceZone& operator=(const TraceZone&) = delete;
+};
+
+#define TRACE_CONCAT_(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_(a, b)
+
+#ifdef TRACE_DISABLED
+#define TRACE_ZONE(...)
+#else
+#define TRACE_ZONE(...) TraceZone TRACE_CONCAT(traceZone, __LINE__)(__VA_ARGS__)
+#endif
+
+#endif // TRACE_H
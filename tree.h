@@ -5,7 +5,11 @@
 #include <queue>
 #include <map>
 #include <algorithm>
+#include <atomic>
+#include <unordered_set>
 #include "state.h"
+#include "leafbatch.h"
+#include "trace.h"
 
 #include <ctime>
 
@@ -51,12 +55,26 @@ public:
         parentNodes.push_back(parent);
     }
 
+    // removes all child nodes, without deleting them
+    void clearChildren() {
+        childNodes.clear();
+        childNodes.shrink_to_fit();
+    }
+
+    // bytes used by node, its state and edges
+    size_t getMemorySize() const {
+        return sizeof(Node) + State::getMemorySize() - sizeof(State) +
+               (parentNodes.capacity() + childNodes.capacity()) * sizeof(Node*);
+    }
+
     State getState() const { return state; }
+    const State& getStateReference() const { return state; }
     vector<Node*> getParentNode() const { return parentNodes; }
     vector<Node*> getChildNodes() const { return childNodes; }
     int getDepth() const { return depth; }
     int getValue() const { return value; }
     void setValue(int value) { this->value = value; }
+    bool isLeaf() const { return childNodes.empty(); }
 
 };
 
@@ -64,6 +82,13 @@ public:
 class Tree {
 private:
     Node* rootNode;
+    size_t memoryUsage = 0;      // bytes used by nodes and edges
+    size_t peakMemoryUsage = 0;  // highest memory usage during generation, including next level
+
+    // bytes evaluateLeaves uses per node: visited set entry and bucket, leaf pointer,
+    // batch counts and value
+    static constexpr size_t LEAF_PASS_NODE_SIZE =
+        3 * sizeof(void*) + sizeof(Node*) + 4 * sizeof(int32_t) + sizeof(int);
 
 public:
     Tree() {}
@@ -73,6 +98,7 @@ public:
     }
 
     ~Tree() {
+        TRACE_ZONE("Tree::~Tree");
         vector<Node*> nodes = getAllNodes();
         for (Node* node : nodes) {
             delete node;
@@ -80,49 +106,100 @@ public:
     }
 
     // generate tree, takes in tree depth as argument, if not given, generates full tree
-    void generateTree(int depth = -1) {
+    // if memory budget in bytes is given and exceeded, the incomplete level is removed
+    // budget covers nodes, the level queue and map, and what evaluateLeaves adds per node
+    // generation also stops when stopFlag is set, the tree is then incomplete
+    // returns depth of the generated tree, the index of its last level
+    int generateTree(int depth = -1, size_t memoryBudget = 0, const atomic<bool>* stopFlag = nullptr) {
+        TRACE_ZONE("Tree::generateTree", depth);
         queue<Node*> curLevel;         // nodes at current depth
         map<State, Node*> nextLevel;   // unique nodes at next depth
+        vector<Node*> expandedNodes;   // nodes at current depth that have children
         vector<State> states;          // nodes possible child states
         Node* curNode;                 // currently looked at node
         int curDepth = 0;              // current depth
 
+        // bytes used by one next level map entry
+        const size_t nextLevelEntrySize =
+            State::mapNodeSize<pair<const State, Node*>>() + State::getMemorySize() - sizeof(State);
+        size_t nodeCount = 1;
+
         curLevel.push(rootNode);
+        memoryUsage = rootNode->getMemorySize();
+        peakMemoryUsage = memoryUsage;
 
         // iterate while there are nodes in current level or until depth is reached
         while (!curLevel.empty() && (depth == -1 || curDepth < depth)) {
             curNode = curLevel.front();
             curLevel.pop();
 
+            size_t nodeMemory = curNode->getMemorySize();
+
             // generate current node's possible child states
             states = generateChildStates(curNode->getState());
             for (State state : states) {
                 auto result = nextLevel.find(state);
                 // if state not found in next level, create new node and add it to next level
                 if (result == nextLevel.end()) {
-                    nextLevel.emplace(state, curNode->addNewChild(state));
+                    Node* childNode = curNode->addNewChild(state);
+                    nextLevel.emplace(state, childNode);
+                    memoryUsage += childNode->getMemorySize();
+                    nodeCount++;
                 }
                 // if state found in next level, connect them
                 else {
+                    size_t childMemory = result->second->getMemorySize();
                     result->second->addParent(curNode);
                     curNode->addChild(result->second);
+                    memoryUsage += result->second->getMemorySize() - childMemory;
+                }
+            }
+
+            memoryUsage += curNode->getMemorySize() - nodeMemory;
+            expandedNodes.push_back(curNode);
+
+            size_t totalMemory = memoryUsage + nextLevel.size() * nextLevelEntrySize +
+                                 (curLevel.size() + expandedNodes.size()) * sizeof(Node*) +
+                                 nodeCount * LEAF_PASS_NODE_SIZE;
+            peakMemoryUsage = max(peakMemoryUsage, totalMemory);
+
+            // if memory budget is exceeded, remove incomplete next level
+            // first level is always kept, so that a move can be found
+            bool isStopped = stopFlag && stopFlag->load(memory_order_relaxed);
+            if (isStopped || (memoryBudget > 0 && curDepth > 0 && totalMemory > memoryBudget)) {
+                for (Node* node : expandedNodes) {
+                    memoryUsage -= node->getMemorySize();
+                    node->clearChildren();
+                    memoryUsage += node->getMemorySize();
+                }
+                for (const auto& pair : nextLevel) {
+                    memoryUsage -= pair.second->getMemorySize();
+                    delete pair.second;
                 }
+
+                return curDepth;
             }
 
             // if current level is completed, go to next level
+            // a level of only end states is the last one
             if (curLevel.empty()) {
+                if (nextLevel.empty()) break;
+
                 for (const auto& pair : nextLevel) {
                     curLevel.push(pair.second);
                 }
                 nextLevel.clear();
+                expandedNodes.clear();
 
                 curDepth++;
             }
         }
+
+        return curDepth;
     }
 
     // generates and returns all child states
-    vector<State> generateChildStates(State parentState) {
+    static vector<State> generateChildStates(State parentState) {
         vector<State> states;  // generated states
         State state;           // current state
 
@@ -153,7 +230,47 @@ public:
         return states;
     }
 
+    // sets heuristic values of all leaf nodes in one batch, after generateTree
+    // minimax and alfabeta can then read leaf values instead of copying the state
+    // on every visit of a leaf, returns leaf count
+    int evaluateLeaves() {
+        TRACE_ZONE("Tree::evaluateLeaves");
+        vector<Node*> leaves;
+        LeafBatch batch;
+        unordered_set<Node*> visitedNodes = {rootNode};
+        vector<Node*> stack = {rootNode};
+
+        // leaves are end states and nodes at the last generated level
+        while (!stack.empty()) {
+            Node* node = stack.back();
+            stack.pop_back();
+
+            if (node->isLeaf()) {
+                const State& state = node->getStateReference();
+                leaves.push_back(node);
+                batch.add(state.getPoints(), state.getBank(),
+                          state.getCount(1) + state.getCount(3), state.getCount(2) + state.getCount(4));
+                continue;
+            }
+
+            for (Node* child : node->getChildNodes()) {
+                if (visitedNodes.insert(child).second)
+                    stack.push_back(child);
+            }
+        }
+
+        vector<int> values(batch.size());
+        batch.evaluate(values.data());
+        for (size_t i = 0; i < leaves.size(); i++) {
+            leaves[i]->setValue(values[i]);
+        }
+
+        return leaves.size();
+    }
+
     Node* getRoot() const { return rootNode; }
+    size_t getMemoryUsage() const { return memoryUsage; }
+    size_t getPeakMemoryUsage() const { return peakMemoryUsage; }
 
     // retrieves all nodes
     vector<Node*> getAllNodes() {